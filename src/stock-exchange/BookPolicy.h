@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "FlatBookSide.h"
+#include "IStockExchange.h"
+#include "Matching.h"
+#include "OrderBook.h"
+#include "Price.h"
+#include "PriceLevel.h"
+#include "RingLevel.h"
+#include "TreeBookSide.h"
+
+// Compile-time configuration of a matching engine: which book every symbol
+// gets and what it's made of. MatchingEngine<Policy> is compiled once
+// per policy, so the book type, queue layout and matching rule are all
+// known statically inside the matching loop.
+//
+//   Side:     TreeSide or FlatSide (flat array with a bitmap index)
+//   Queue:    PriceLevel (linked nodes) or RingLevel (contiguous ring)
+//   Matching: FifoMatching or ProRataMatching
+template<template<typename, typename, typename> class Side, typename Queue, typename Matching>
+struct BookPolicy {
+  using Level = Queue;
+  using Book = BasicOrderBook<Side<std::greater<Price>, Queue, Matching>,
+                              Side<std::less<Price>, Queue, Matching>>;
+};
+
+// The runtime-configurable engine: each symbol picks TREE or FLAT through
+// ConfigureBook, at the cost of one std::visit per order.
+struct MixedPolicy {
+  using Level = PriceLevel;
+  using Book = std::variant<OrderBook, FlatOrderBook>;
+};
+
+// Which policy an instrument class compiles to. Primary template left
+// undefined: a class without a specialization doesn't compile.
+template<InstrumentClass>
+struct PolicyFor;
+
+template<>
+struct PolicyFor<InstrumentClass::MIXED> {
+  using type = MixedPolicy;
+};
+template<>
+struct PolicyFor<InstrumentClass::EQUITY> {
+  using type = BookPolicy<FlatSide, PriceLevel, FifoMatching>;
+};
+template<>
+struct PolicyFor<InstrumentClass::WIDE_RANGE> {
+  using type = BookPolicy<TreeSide, PriceLevel, FifoMatching>;
+};
+// pro-rata reads a whole level per fill, which the ring keeps contiguous
+template<>
+struct PolicyFor<InstrumentClass::PRO_RATA> {
+  using type = BookPolicy<FlatSide, RingLevel, ProRataMatching>;
+};
+
+// IsVariant<Book>: whether a policy's book has to be visited or can be
+// called directly.
+template<typename T>
+struct IsVariant {
+  static constexpr bool value = false;
+};
+template<typename... Ts>
+struct IsVariant<std::variant<Ts...>> {
+  static constexpr bool value = true;
+};
+
+// Call p_Fn with the concrete book: std::visit for MixedPolicy, a plain
+// call (no dispatch at all) for everything else.
+template<typename Book, typename Fn>
+decltype(auto) VisitBook(Book& p_Book, Fn&& p_Fn) {
+  if constexpr (IsVariant<std::remove_const_t<Book>>::value) {
+    return std::visit(std::forward<Fn>(p_Fn), p_Book);
+  } else {
+    return std::forward<Fn>(p_Fn)(p_Book);
+  }
+}
+
+// The storage all of an engine's books share: a node pool (huge pages if
+// configured) for PriceLevel, nothing for RingLevel.
+template<typename Storage>
+Storage MakeStorage(const EngineConfig& p_Config) {
+  if constexpr (std::is_constructible_v<Storage, bool>) {
+    return Storage(p_Config.hugePages);
+  } else {
+    return Storage{};
+  }
+}
+
+// A fresh book for a symbol configured with p_Config. Fixed-layout books
+// only take what applies to them (the window widths for flat ones).
+template<typename Book, typename Storage>
+Book MakeBook(Storage& p_Storage, const BookConfig& p_Config) {
+  if constexpr (IsVariant<Book>::value) {
+    if (p_Config.type == BookType::FLAT) return Book(FlatOrderBook(p_Storage, p_Config.levels, p_Config.maxLevels));
+    return Book(OrderBook(p_Storage));
+  } else if constexpr (std::is_constructible_v<Book, Storage&, std::size_t, std::size_t>) {
+    return Book(p_Storage, p_Config.levels, p_Config.maxLevels);
+  } else {
+    return Book(p_Storage);
+  }
+}
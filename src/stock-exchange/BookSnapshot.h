@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "Callback.h"
+#include "Epoch.h"
+#include "IStockExchange.h"
+#include "LevelSummary.h"
+#include "Price.h"
+#include "SymbolDirectory.h"
+
+// One book's levels, best first on both sides, as of the execution report
+// with number sequence. Immutable once published.
+struct BookSnapshot {
+  std::uint64_t sequence = 0;
+  std::vector<LevelSummary> bids;
+  std::vector<LevelSummary> asks;
+
+  // Same contract as OrderBook::Depth: up to p_Max levels of p_Side, best
+  // first, or only those worse than p_After if given.
+  template<typename Fn>
+  void Depth(Order::Operation p_Side, std::size_t p_Max, Fn&& p_Fn,
+             std::optional<Price> p_After = std::nullopt) const {
+    bool buy = p_Side == Order::Operation::BUY;
+    const std::vector<LevelSummary>& levels = buy ? bids : asks;
+    auto level = levels.begin();
+    if (p_After) {
+      level = std::partition_point(levels.begin(), levels.end(), [&](const LevelSummary& p_Level) {
+        return buy ? p_Level.price >= *p_After : p_Level.price <= *p_After;
+      });
+    }
+    for (; level != levels.end() && p_Max > 0; ++level, --p_Max) {
+      if (!VisitLevel(p_Fn, *level)) return;
+    }
+  }
+};
+
+// The latest BookSnapshot of every symbol, readable from any thread while
+// the matcher keeps publishing newer ones. A reader pins an epoch (see
+// Epoch.h) and reads the snapshot in place; a replaced snapshot is only
+// reused once no reader that could have seen it is still pinned. Snapshots
+// are recycled rather than freed, so steady publishing doesn't allocate.
+class SnapshotBoard {
+public:
+  // p_Levels per side, 0 for no snapshots at all
+  SnapshotBoard(std::size_t p_Symbols, std::size_t p_Levels)
+    : m_Current(std::make_unique<std::atomic<BookSnapshot*>[]>(p_Levels > 0 ? p_Symbols : 0)),
+      m_Size(p_Levels > 0 ? p_Symbols : 0), m_Levels(p_Levels) {}
+
+  bool Enabled() const { return m_Size > 0; }
+  std::size_t Levels() const { return m_Levels; }
+  // whether p_Symbol gets snapshots
+  bool Covers(SymbolId p_Symbol) const { return p_Symbol < m_Size; }
+
+  // Matcher only. An empty snapshot to fill and Publish.
+  BookSnapshot& Acquire() {
+    if (m_Free.empty()) {
+      m_All.push_back(std::make_unique<BookSnapshot>());
+      m_Free.push_back(m_All.back().get());
+    }
+    BookSnapshot& snapshot = *m_Free.back();
+    m_Free.pop_back();
+    snapshot.bids.clear();
+    snapshot.asks.clear();
+    return snapshot;
+  }
+
+  // Matcher only. Makes p_Snapshot (from Acquire) p_Symbol's latest, for a
+  // covered symbol; the one it replaces is retired.
+  void Publish(SymbolId p_Symbol, BookSnapshot& p_Snapshot) {
+    BookSnapshot* old = m_Current[p_Symbol].exchange(&p_Snapshot, std::memory_order_seq_cst);
+    if (old) m_Retired.push_back(Retired{m_Epochs.Epoch(), old});
+  }
+
+  // Matcher only, after a round of Publish: recycle what no reader can see
+  // any more and start a new epoch.
+  void Reclaim() {
+    if (m_Retired.empty()) return;
+    m_Epochs.Advance();
+    std::uint64_t oldest = m_Epochs.Oldest();
+    // retired in epoch order, so the reusable ones are a prefix
+    std::size_t done = 0;
+    while (done < m_Retired.size() && m_Retired[done].epoch < oldest) m_Free.push_back(m_Retired[done++].snapshot);
+    m_Retired.erase(m_Retired.begin(), m_Retired.begin() + static_cast<std::ptrdiff_t>(done));
+  }
+
+  // Any thread. p_Read(snapshot) on p_Symbol's latest snapshot; false,
+  // without calling it, if there is none yet.
+  bool Read(SymbolId p_Symbol, FunctionRef<void(const BookSnapshot&)> p_Read) const {
+    if (p_Symbol >= m_Size) return false;
+    EpochDomain::Guard guard = m_Epochs.Pin();
+    const BookSnapshot* snapshot = m_Current[p_Symbol].load(std::memory_order_seq_cst);
+    if (!snapshot) return false;
+    p_Read(*snapshot);
+    return true;
+  }
+
+private:
+  struct Retired {
+    std::uint64_t epoch;
+    BookSnapshot* snapshot;
+  };
+
+  std::unique_ptr<std::atomic<BookSnapshot*>[]> m_Current;
+  std::size_t m_Size;
+  std::size_t m_Levels;
+  EpochDomain m_Epochs;
+
+  // matcher side: every snapshot ever made, the retired ones oldest first,
+  // and the ones ready for reuse
+  std::vector<std::unique_ptr<BookSnapshot>> m_All;
+  std::vector<Retired> m_Retired;
+  std::vector<BookSnapshot*> m_Free;
+};
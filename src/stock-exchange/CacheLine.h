@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Fixed rather than std::hardware_destructive_interference_size, which
+// varies with compiler flags and would make the layout ABI-dependent.
+constexpr std::size_t kCacheLineSize = 64;
+
+// Spin-wait hint: lets the sibling hyperthread run and saves power while a
+// thread polls a queue.
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+// Start pulling the line holding p_Address into L1 for writing. Used to
+// overlap the next miss with work on the current element when walking
+// linked structures, where the hardware prefetcher can't guess the address.
+inline void PrefetchForWrite(const void* p_Address) {
+  __builtin_prefetch(p_Address, 1, 3);
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Allocation-free callable wrappers for callbacks on the matching path.
+// std::function may heap-allocate whatever it captures and always calls
+// through type erasure; these never allocate, and FunctionRef is just two
+// words the optimizer can often see through.
+
+template<typename Signature>
+class FunctionRef;
+
+// Non-owning reference to any callable. The callable must outlive the
+// FunctionRef, so use it for parameters that are only called during the
+// call they're passed to, never for storing.
+template<typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+public:
+  template<typename F,
+           typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, FunctionRef> &&
+                                       std::is_invocable_r_v<R, F&, Args...>>>
+  FunctionRef(F&& p_Callable)
+    : m_Object(const_cast<void*>(static_cast<const void*>(std::addressof(p_Callable)))),
+      m_Invoke([](void* p_Object, Args... p_Args) -> R {
+        return (*static_cast<std::add_pointer_t<F>>(p_Object))(std::forward<Args>(p_Args)...);
+      }) {}
+
+  R operator()(Args... p_Args) const { return m_Invoke(m_Object, std::forward<Args>(p_Args)...); }
+
+private:
+  void* m_Object;
+  R (*m_Invoke)(void*, Args...);
+};
+
+template<typename Signature, std::size_t Capacity = 32>
+class InplaceFunction;
+
+// Owning callable stored inside the object itself, like std::function with
+// the small-buffer optimization but without the heap fallback: a callable
+// bigger than Capacity is a compile error instead of an allocation.
+template<typename R, typename... Args, std::size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+  InplaceFunction() = default;
+
+  template<typename F,
+           typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction> &&
+                                       std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+  InplaceFunction(F&& p_Callable) {
+    using Callable = std::decay_t<F>;
+    static_assert(sizeof(Callable) <= Capacity, "callable too big for this InplaceFunction");
+    static_assert(alignof(Callable) <= alignof(std::max_align_t), "callable over-aligned");
+    static_assert(std::is_copy_constructible_v<Callable>, "callable must be copyable");
+    ::new (static_cast<void*>(m_Storage)) Callable(std::forward<F>(p_Callable));
+    m_Invoke = [](void* p_Object, Args... p_Args) -> R {
+      return (*static_cast<Callable*>(p_Object))(std::forward<Args>(p_Args)...);
+    };
+    m_Manage = [](Operation p_Operation, void* p_Destination, void* p_Source) {
+      switch (p_Operation) {
+        case Operation::COPY:
+          ::new (p_Destination) Callable(*static_cast<const Callable*>(p_Source));
+          break;
+        case Operation::MOVE:
+          ::new (p_Destination) Callable(std::move(*static_cast<Callable*>(p_Source)));
+          static_cast<Callable*>(p_Source)->~Callable();
+          break;
+        case Operation::DESTROY:
+          static_cast<Callable*>(p_Destination)->~Callable();
+          break;
+      }
+    };
+  }
+
+  InplaceFunction(const InplaceFunction& p_Other) { CopyFrom(p_Other); }
+  InplaceFunction(InplaceFunction&& p_Other) noexcept { MoveFrom(p_Other); }
+
+  InplaceFunction& operator=(const InplaceFunction& p_Other) {
+    if (this != &p_Other) {
+      Reset();
+      CopyFrom(p_Other);
+    }
+    return *this;
+  }
+
+  InplaceFunction& operator=(InplaceFunction&& p_Other) noexcept {
+    if (this != &p_Other) {
+      Reset();
+      MoveFrom(p_Other);
+    }
+    return *this;
+  }
+
+  ~InplaceFunction() { Reset(); }
+
+  explicit operator bool() const { return m_Invoke != nullptr; }
+
+  R operator()(Args... p_Args) const {
+    return m_Invoke(const_cast<unsigned char*>(m_Storage), std::forward<Args>(p_Args)...);
+  }
+
+private:
+  enum class Operation {
+    COPY, MOVE, DESTROY
+  };
+
+  void CopyFrom(const InplaceFunction& p_Other) {
+    if (!p_Other.m_Manage) return;
+    p_Other.m_Manage(Operation::COPY, m_Storage, const_cast<unsigned char*>(p_Other.m_Storage));
+    m_Invoke = p_Other.m_Invoke;
+    m_Manage = p_Other.m_Manage;
+  }
+
+  void MoveFrom(InplaceFunction& p_Other) {
+    if (!p_Other.m_Manage) return;
+    p_Other.m_Manage(Operation::MOVE, m_Storage, p_Other.m_Storage);
+    m_Invoke = p_Other.m_Invoke;
+    m_Manage = p_Other.m_Manage;
+    p_Other.m_Invoke = nullptr;
+    p_Other.m_Manage = nullptr;
+  }
+
+  void Reset() {
+    if (m_Manage) m_Manage(Operation::DESTROY, m_Storage, nullptr);
+    m_Invoke = nullptr;
+    m_Manage = nullptr;
+  }
+
+  alignas(std::max_align_t) unsigned char m_Storage[Capacity];
+  R (*m_Invoke)(void*, Args...) = nullptr;
+  void (*m_Manage)(Operation, void*, void*) = nullptr;
+};
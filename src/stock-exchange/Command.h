@@ -0,0 +1,28 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "IStockExchange.h"
+
+// One unit of work for a matching thread, in arrival order. Queued engines
+// turn every IStockExchange call into one of these so the books are only
+// ever touched by the thread that owns them.
+struct Command {
+  enum class Type {
+    ORDER, REGISTER, CONFIGURE, CANCEL, MODIFY, BATCH
+  };
+
+  Type type = Type::ORDER;
+  // ORDER: the order. REGISTER/CONFIGURE: order.symbol is the name.
+  // CANCEL/MODIFY: order.symbolId and order.id, and the new
+  // order.volume/price for MODIFY.
+  Order order;
+  BookConfig config; // CONFIGURE
+  // CONFIGURE: if set, told whether the book took the config
+  std::promise<bool>* configured = nullptr;
+  // BATCH: one shard's part of a ProcessBatch, matched as a batch. Behind a
+  // pointer so a queue slot stays within two cache lines.
+  std::unique_ptr<std::vector<Order>> batch = nullptr;
+};
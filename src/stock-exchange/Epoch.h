@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <utility>
+
+#include "CacheLine.h"
+
+// Epoch-based reclamation for one writer and any number of readers.
+//
+// Readers Pin() the current epoch for as long as they hold pointers into
+// shared data. The writer unlinks an object, tags it with Epoch() and keeps
+// it until Quiescent(tag): every pinned reader pinned later than that, so
+// none can still see the object. Advance() moves the epoch on, typically
+// once per round of retirements.
+//
+// Readers never wait on the writer and the writer never waits on readers;
+// a reader that stays pinned only delays reclamation. Pins take one of
+// kMaxReaders slots, each on its own cache line so readers don't bounce
+// lines between them; with all of them in use Pin() spins for one to free
+// up.
+class EpochDomain {
+  struct alignas(kCacheLineSize) Slot {
+    std::atomic<std::uint64_t> epoch{kIdle};
+  };
+
+public:
+  static constexpr std::size_t kMaxReaders = 64;
+
+  // Keeps a reader's epoch pinned until it goes out of scope.
+  class Guard {
+  public:
+    Guard(Guard&& p_Other) noexcept : m_Slot(std::exchange(p_Other.m_Slot, nullptr)) {}
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+    ~Guard() {
+      if (m_Slot) m_Slot->epoch.store(kIdle, std::memory_order_release);
+    }
+
+  private:
+    friend class EpochDomain;
+    explicit Guard(Slot& p_Slot) : m_Slot(&p_Slot) {}
+
+    Slot* m_Slot;
+  };
+
+  // Any thread. Pointers loaded after this (seq_cst) stay valid until the
+  // Guard goes.
+  Guard Pin() const {
+    // start where this thread last found a free slot, so steady readers
+    // keep to their own line
+    thread_local std::size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    for (;;) {
+      std::uint64_t epoch = m_Epoch.load(std::memory_order_seq_cst);
+      for (std::size_t i = 0; i < kMaxReaders; ++i) {
+        Slot& slot = m_Slots[(hint + i) % kMaxReaders];
+        std::uint64_t idle = kIdle;
+        if (slot.epoch.load(std::memory_order_relaxed) == kIdle &&
+            slot.epoch.compare_exchange_strong(idle, epoch, std::memory_order_seq_cst)) {
+          hint += i;
+          return Guard(slot);
+        }
+      }
+      CpuRelax();
+    }
+  }
+
+  // Writer only. The tag for objects unlinked now.
+  std::uint64_t Epoch() const { return m_Epoch.load(std::memory_order_relaxed); }
+
+  // Writer only.
+  void Advance() { m_Epoch.fetch_add(1, std::memory_order_seq_cst); }
+
+  // Writer only. Whether no reader can still hold what was retired with
+  // p_Tag.
+  bool Quiescent(std::uint64_t p_Tag) const { return Oldest() > p_Tag; }
+
+  // Writer only. The earliest pinned epoch, kIdle if nobody is pinned.
+  std::uint64_t Oldest() const {
+    std::uint64_t oldest = kIdle;
+    for (const Slot& slot : m_Slots) {
+      std::uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+      if (epoch < oldest) oldest = epoch;
+    }
+    return oldest;
+  }
+
+private:
+  static constexpr std::uint64_t kIdle = std::numeric_limits<std::uint64_t>::max();
+
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> m_Epoch{0};
+  mutable std::array<Slot, kMaxReaders> m_Slots;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Callback.h"
+#include "Price.h"
+#include "SpscRing.h"
+#include "SymbolDirectory.h"
+
+// Caller-chosen order identifier, echoed back in every report for the order.
+// Ids must be unique among resting orders; kNoOrderId opts out of
+// Cancel/Modify.
+using OrderId = std::uint64_t;
+
+constexpr OrderId kNoOrderId = 0;
+
+// What happened to an order. Every incoming order gets NEW or REJECTED
+// first, then one PARTIAL_FILL/FILL per trade. Both the incoming and the
+// resting order get a report for each trade. A Cancel answers CANCELED and a
+// Modify REPLACED (followed by fills if the new price crosses), or REJECTED
+// if no such order rests under the given symbol.
+struct ExecutionReport {
+  enum class Type : std::uint8_t {
+    NEW, PARTIAL_FILL, FILL, REJECTED, CANCELED, REPLACED
+  };
+
+  // per engine (per shard when sharded); a gap means reports were lost,
+  // see ReportStream
+  std::uint64_t sequence;
+  OrderId orderId;
+  Price price;            // fill price; the limit price for NEW/REJECTED
+  SymbolId symbol;
+  int quantity;           // filled by this trade; 0 for NEW/REJECTED
+  int leaves;             // still open after this report
+  Type type;
+};
+
+// Report stream from one matching thread to one consumer thread.
+//
+// The matcher Publish()es into a fixed staging array and Flush()es it into
+// a preallocated SPSC ring in one go, usually once per order or per batch;
+// a sweep that stages more than the array holds spills it early. If the
+// consumer falls behind and the ring is full, Flush chains another ring of
+// the same size behind it and carries on there. Those rings are all
+// allocated up front, enough for p_Backlog reports, and the consumer hands
+// each one back once it has emptied it, so the matcher never allocates and
+// never waits. A flushed report is always the consumer's to take. Only a
+// consumer more than p_Backlog reports behind the first ring loses any:
+// they are counted, and the gap in their sequence numbers shows where.
+class ReportStream {
+public:
+  // reports staged between two Flushes before Publish spills them
+  static constexpr std::size_t kStaged = 256;
+
+  explicit ReportStream(std::size_t p_Capacity, std::size_t p_Backlog = 0)
+    : m_Head(new Segment(p_Capacity)), m_Tail(m_Head), m_Free(Spares(m_Head->ring.Capacity(), p_Backlog)) {
+    m_Segments.emplace_back(m_Head);
+    for (std::size_t i = 0; i < Spares(m_Head->ring.Capacity(), p_Backlog); ++i) {
+      m_Segments.push_back(std::make_unique<Segment>(p_Capacity));
+      m_Free.TryPush(m_Segments.back().get());
+    }
+  }
+
+  ReportStream(const ReportStream&) = delete;
+  ReportStream& operator=(const ReportStream&) = delete;
+
+  // Matcher only. Stamps the sequence number.
+  void Publish(ExecutionReport p_Report) {
+    p_Report.sequence = m_NextSequence++;
+    m_Staged[m_StagedCount++] = p_Report;
+    if (m_StagedCount == kStaged) Flush();
+  }
+
+  // Matcher only. The sequence number of the last Publish (meaningless
+  // before the first).
+  std::uint64_t LastSequence() const { return m_NextSequence - 1; }
+
+  // Any thread. Reports lost to a consumer too far behind so far.
+  std::uint64_t Dropped() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+  // Matcher only. Hands every staged report to the consumer, chaining a
+  // spare ring if the last one is full; one release store per ring touched.
+  void Flush() {
+    std::size_t pushed = 0;
+    while (pushed < m_StagedCount) {
+      pushed += m_Tail->ring.TryPushSome(m_Staged.data() + pushed, m_StagedCount - pushed);
+      if (pushed < m_StagedCount && !Grow()) {
+        m_Dropped.fetch_add(m_StagedCount - pushed, std::memory_order_relaxed);
+        break;
+      }
+    }
+    m_StagedCount = 0;
+  }
+
+  // Consumer only. Hands up to p_Max reports to p_Consume, oldest first.
+  std::size_t Drain(FunctionRef<void(const ExecutionReport&)> p_Consume, std::size_t p_Max) {
+    auto consume = [&](ExecutionReport& p_Report) { p_Consume(p_Report); };
+    std::size_t count = 0;
+    for (;;) {
+      count += m_Head->ring.Drain(consume, p_Max - count);
+      if (count == p_Max) return count;
+      Segment* next = m_Head->next.load(std::memory_order_acquire);
+      if (!next) return count;
+      // the matcher is done with this ring: all it pushed here happened
+      // before it linked the next one
+      count += m_Head->ring.Drain(consume, p_Max - count);
+      if (count == p_Max) return count;
+      // empty now; back to the matcher for the next time it runs out
+      Segment* done = std::exchange(m_Head, next);
+      done->next.store(nullptr, std::memory_order_relaxed);
+      m_Free.TryPush(std::move(done));
+    }
+  }
+
+private:
+  struct Segment {
+    explicit Segment(std::size_t p_Capacity) : ring(p_Capacity) {}
+
+    SpscRing<ExecutionReport> ring;
+    std::atomic<Segment*> next{nullptr};
+  };
+
+  // rings behind the first one that p_Backlog takes
+  static std::size_t Spares(std::size_t p_Capacity, std::size_t p_Backlog) {
+    return (p_Backlog + p_Capacity - 1) / p_Capacity;
+  }
+
+  // Matcher only. Links a spare ring behind the last one; false if the
+  // consumer holds all of them.
+  bool Grow() {
+    Segment* segment = nullptr;
+    if (m_Free.Drain([&](Segment* p_Spare) { segment = p_Spare; }, 1) == 0) return false;
+    m_Tail->next.store(segment, std::memory_order_release);
+    m_Tail = segment;
+    return true;
+  }
+
+  // the oldest ring (consumer side) and the one being filled (matcher side)
+  Segment* m_Head;
+  Segment* m_Tail;
+  // the rings not in the chain, handed back by the consumer; it's this
+  // ring's producer and the matcher its consumer
+  SpscRing<Segment*> m_Free;
+  // every ring, chained or spare
+  std::vector<std::unique_ptr<Segment>> m_Segments;
+  // published since the last Flush
+  std::array<ExecutionReport, kStaged> m_Staged;
+  std::size_t m_StagedCount = 0;
+  std::uint64_t m_NextSequence = 0;
+  std::atomic<std::uint64_t> m_Dropped{0};
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "CacheLine.h"
+#include "LevelBitmap.h"
+#include "LevelSummary.h"
+#include "Matching.h"
+#include "Price.h"
+#include "PriceLevel.h"
+
+// One side of a book as a contiguous array of levels indexed by
+// (price - base) / tick. Finding a level is an index computation instead of
+// a tree walk, and neighbouring prices share cache lines. The window
+// re-centers (and grows if needed) when an order lands outside of it, but
+// never grows past p_MaxLevels: an order too far from the resting levels
+// for both to fit doesn't Fit, and the owner turns it away. Nothing is
+// allocated until the first order rests, so a book nobody trades costs a
+// few words (every shard keeps one per symbol).
+//
+// Level is the queue layout of each price level, PriceLevel or RingLevel,
+// and Matching the rule that shares a fill out within a level.
+template<typename Compare, typename Level = PriceLevel, typename Matching = FifoMatching>
+class FlatSide {
+public:
+  using LevelType = Level;
+  using Handle = typename Level::Handle;
+  using Storage = typename Level::Storage;
+
+  // p_Levels is the width of the first window; at least one level, as
+  // Recenter grows the window by doubling it.
+  explicit FlatSide(Storage& p_Storage, std::size_t p_Levels = 4096, std::size_t p_MaxLevels = std::size_t{1} << 18)
+    : m_Storage(&p_Storage), m_Width(std::max(p_Levels, std::size_t{1})),
+      m_MaxLevels(std::max(m_Width, p_MaxLevels)) {}
+
+  bool Empty() const { return m_Lo > m_Hi; }
+
+  std::optional<Price> BestPrice() const {
+    if (Empty()) return std::nullopt;
+    return PriceOf(Best());
+  }
+
+  // The best level with its totals. O(1).
+  std::optional<LevelSummary> Top() const {
+    if (Empty()) return std::nullopt;
+    return Summary(Best());
+  }
+
+  // p_Fn(const LevelSummary&) for up to p_Max non-empty levels, best first,
+  // or only those worse than p_After if given; see VisitLevel for stopping
+  // early. Steps through the bitmap: O(p_Max) however sparse the side is.
+  template<typename Fn>
+  void Depth(std::size_t p_Max, Fn&& p_Fn, std::optional<Price> p_After = std::nullopt) const {
+    if (Empty()) return;
+    long index = Best();
+    if (p_After) {
+      // p_After comes from the caller's cursor and may be anywhere by now:
+      // clamp it to the occupied range, and stop if nothing worse is left
+      long after = Offset(*p_After);
+      if (IsBid ? after <= m_Lo : after >= m_Hi) return;
+      index = IsBid ? m_Occupied.Prev(std::min(after - 1, m_Hi)) : m_Occupied.Next(std::max(after + 1, m_Lo));
+    }
+    for (; p_Max > 0; --p_Max) {
+      if (index == LevelBitmap::kNone || index < m_Lo || index > m_Hi) return;
+      if (!VisitLevel(p_Fn, Summary(index))) return;
+      index = IsBid ? m_Occupied.Prev(index - 1) : m_Occupied.Next(index + 1);
+    }
+  }
+
+  // The level at p_Price, if any order rests there. O(1).
+  std::optional<LevelSummary> LevelAt(Price p_Price) const {
+    long index = Offset(p_Price);
+    if (index < m_Lo || index > m_Hi || m_Levels[index].Empty()) return std::nullopt;
+    return Summary(index);
+  }
+
+  bool Crosses(Price p_Price) const {
+    return !Empty() && !Compare{}(p_Price, PriceOf(Best()));
+  }
+
+  // Whether an order at p_Price could rest here: the window must cover it
+  // and every resting level without growing past the maximum width. O(1).
+  bool Fits(Price p_Price) const {
+    std::int64_t index;
+    if (__builtin_sub_overflow(p_Price.ticks, m_BaseTick, &index)) return false;
+    if (index >= 0 && index < static_cast<std::int64_t>(m_Levels.size())) return true;
+    if (Empty()) return true;
+    auto [lo, hi] = Occupied();
+    std::int64_t span = std::max<std::int64_t>(hi, index) - std::min<std::int64_t>(lo, index) + 1;
+    return span > 0 && span <= static_cast<std::int64_t>(m_MaxLevels);
+  }
+
+  // p_Order's price must Fit.
+  Handle Rest(const RestingOrder& p_Order) {
+    long index = static_cast<long>(p_Order.price.ticks - m_BaseTick);
+    if (index < 0 || index >= static_cast<long>(m_Levels.size())) {
+      index = Recenter(index);
+    }
+    Handle handle = m_Levels[index].Rest(*m_Storage, p_Order);
+    m_Occupied.Set(index);
+    if (index < m_Lo) m_Lo = index;
+    if (index > m_Hi) m_Hi = index;
+    return handle;
+  }
+
+  RestingOrder At(const Handle& p_Handle) const { return m_Levels[IndexOf(p_Handle)].At(*m_Storage, p_Handle); }
+
+  // Shrink the order at p_Handle to p_Volume in place; it keeps its place.
+  void Reduce(const Handle& p_Handle, int p_Volume) {
+    m_Levels[IndexOf(p_Handle)].Reduce(*m_Storage, p_Handle, p_Volume);
+  }
+
+  // Remove the order at p_Handle from this side. O(1): the level is found
+  // by index.
+  template<typename OnMove>
+  void Cancel(const Handle& p_Handle, OnMove&& p_OnMove) {
+    long index = IndexOf(p_Handle);
+    m_Levels[index].Cancel(*m_Storage, p_Handle, p_OnMove);
+    if (!m_Levels[index].Empty()) return;
+    m_Occupied.Clear(index);
+    if (index == Best()) AdvanceBest();
+  }
+
+  template<typename OnFill>
+  int FillBest(int p_Volume, OnFill&& p_OnFill) {
+    long best = Best();
+    int filled = Matching::Fill(m_Levels[best], *m_Storage, p_Volume, p_OnFill);
+    if (m_Levels[best].Empty()) {
+      m_Occupied.Clear(best);
+      AdvanceBest();
+    }
+    return filled;
+  }
+
+  // Start loading the first order of the level after the best one, so a
+  // sweep that runs through the best level finds the next one in cache.
+  void PrefetchSecond() const {
+    if (Empty()) return;
+    long next = IsBid ? m_Occupied.Prev(m_Hi - 1) : m_Occupied.Next(m_Lo + 1);
+    if (next == LevelBitmap::kNone || next < m_Lo || next > m_Hi) return;
+    if (auto* front = m_Levels[next].Front(*m_Storage)) PrefetchForWrite(front);
+  }
+
+private:
+  static constexpr bool IsBid = Compare{}(Price{1}, Price{0});
+
+  // [m_Lo, m_Hi] bounds every non-empty level. The bound on the best side is
+  // exact, the other one may be loose after fills.
+  long Best() const { return IsBid ? m_Hi : m_Lo; }
+
+  Price PriceOf(long p_Index) const { return Price{m_BaseTick + p_Index}; }
+
+  // p_Price's index in the window, for any price: one too far to subtract
+  // saturates, which still compares right against m_Lo and m_Hi.
+  long Offset(Price p_Price) const {
+    std::int64_t index;
+    if (__builtin_sub_overflow(p_Price.ticks, m_BaseTick, &index)) {
+      return p_Price.ticks < 0 ? std::numeric_limits<long>::min() : std::numeric_limits<long>::max();
+    }
+    return static_cast<long>(index);
+  }
+  LevelSummary Summary(long p_Index) const {
+    return LevelSummary{PriceOf(p_Index), m_Levels[p_Index].Volume(), m_Levels[p_Index].Count()};
+  }
+  long IndexOf(const Handle& p_Handle) const {
+    return static_cast<long>(Level::PriceOf(*m_Storage, p_Handle).ticks - m_BaseTick);
+  }
+
+  // the best level just emptied, jump to the next occupied one towards
+  // worse prices (a few ctz/clz, however many empty levels are skipped)
+  void AdvanceBest() {
+    if (IsBid) {
+      m_Hi = m_Occupied.Prev(m_Hi);
+    } else {
+      m_Lo = m_Occupied.Next(m_Lo);
+    }
+    if (m_Lo == LevelBitmap::kNone || m_Hi == LevelBitmap::kNone || m_Lo > m_Hi) ResetBounds();
+  }
+
+  void ResetBounds() {
+    m_Lo = static_cast<long>(m_Levels.size());
+    m_Hi = -1;
+  }
+
+  // The exact [lo, hi] of a non-empty side: the bound away from the best
+  // one may be loose, the bitmap tightens it.
+  std::pair<long, long> Occupied() const {
+    if (IsBid) return {m_Occupied.Next(m_Lo), m_Hi};
+    return {m_Lo, m_Occupied.Prev(m_Hi)};
+  }
+
+  // Move the window so that both the resting levels and p_Index fit, with
+  // room to drift either way, up to the maximum width (p_Index Fits, so the
+  // span does). Returns p_Index in the new window.
+  long Recenter(long p_Index) {
+    if (!Empty()) std::tie(m_Lo, m_Hi) = Occupied();
+    long lo = Empty() ? p_Index : std::min(m_Lo, p_Index);
+    long hi = Empty() ? p_Index : std::max(m_Hi, p_Index);
+    long span = hi - lo + 1;
+    std::size_t size = std::max(m_Levels.size(), m_Width);
+    while (static_cast<long>(size) < 2 * span) size *= 2;
+    size = std::min(size, m_MaxLevels);
+
+    long shift = lo + span / 2 - static_cast<long>(size) / 2;
+    std::vector<Level> levels(size);
+    m_Occupied.Resize(size);
+    if (!Empty()) {
+      for (long i = m_Lo; i <= m_Hi; ++i) {
+        if (m_Levels[i].Empty()) continue;
+        levels[i - shift].Take(*m_Storage, m_Levels[i]);
+        m_Occupied.Set(i - shift);
+      }
+      m_Lo -= shift;
+      m_Hi -= shift;
+    } else {
+      m_Lo = static_cast<long>(size);
+      m_Hi = -1;
+    }
+    m_Levels = std::move(levels);
+    m_BaseTick += shift;
+    return p_Index - shift;
+  }
+
+  Storage* m_Storage;
+  std::size_t m_Width;
+  std::size_t m_MaxLevels;
+  std::int64_t m_BaseTick = 0;
+  // empty until the first Rest
+  std::vector<Level> m_Levels;
+  // which of m_Levels are non-empty
+  LevelBitmap m_Occupied;
+  long m_Lo = static_cast<long>(m_Levels.size());
+  long m_Hi = -1;
+};
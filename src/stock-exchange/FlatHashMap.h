@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// murmur3 finalizer: sequential ids would otherwise fill one run
+struct IntegerHash {
+  template<typename Key>
+  std::uint64_t operator()(Key p_Key) const {
+    std::uint64_t h = static_cast<std::uint64_t>(p_Key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+};
+
+// Open-addressing hash map for small keys, integers by default: flat arrays
+// of keys and values, linear probing, deletion by backward shift
+// (no tombstones, so lookups never slow down with churn). EmptyKey marks a
+// free slot and can't be stored; other keys need a Hash. Find/Insert/Erase
+// are O(1) expected; only Insert allocates, and only when growing past half
+// full, so Reserve up front to keep it off the hot path entirely.
+template<typename Key, typename Value, Key EmptyKey = Key{}, typename Hash = IntegerHash>
+class FlatHashMap {
+public:
+  explicit FlatHashMap(std::size_t p_Expected = 0) { Reserve(p_Expected); }
+
+  std::size_t Size() const { return m_Size; }
+  std::size_t Bytes() const { return m_Keys.size() * (sizeof(Key) + sizeof(Value)); }
+
+  // make room for p_Count keys without rehashing
+  void Reserve(std::size_t p_Count) {
+    std::size_t capacity = 16;
+    while (capacity < 2 * p_Count) capacity <<= 1;
+    if (capacity > m_Keys.size()) Rehash(capacity);
+  }
+
+  Value* Find(const Key& p_Key) {
+    if (m_Keys.empty()) return nullptr;
+    for (std::size_t i = Home(p_Key);; i = (i + 1) & m_Mask) {
+      if (m_Keys[i] == p_Key) return &m_Values[i];
+      if (m_Keys[i] == EmptyKey) return nullptr;
+    }
+  }
+
+  // false (and no change) if p_Key is already present
+  bool Insert(const Key& p_Key, const Value& p_Value) {
+    if (2 * (m_Size + 1) > m_Keys.size()) Rehash(m_Keys.empty() ? 16 : 2 * m_Keys.size());
+    std::size_t i = Home(p_Key);
+    for (; m_Keys[i] != EmptyKey; i = (i + 1) & m_Mask) {
+      if (m_Keys[i] == p_Key) return false;
+    }
+    m_Keys[i] = p_Key;
+    m_Values[i] = p_Value;
+    ++m_Size;
+    return true;
+  }
+
+  bool Erase(const Key& p_Key) {
+    if (m_Keys.empty()) return false;
+    std::size_t hole = Home(p_Key);
+    for (; m_Keys[hole] != p_Key; hole = (hole + 1) & m_Mask) {
+      if (m_Keys[hole] == EmptyKey) return false;
+    }
+    // shift later members of the probe run back so every key stays
+    // reachable from its home slot
+    for (std::size_t i = (hole + 1) & m_Mask; m_Keys[i] != EmptyKey; i = (i + 1) & m_Mask) {
+      std::size_t home = Home(m_Keys[i]);
+      // move it unless its home lies cyclically in (hole, i]
+      if (((i - home) & m_Mask) >= ((i - hole) & m_Mask)) {
+        m_Keys[hole] = m_Keys[i];
+        m_Values[hole] = m_Values[i];
+        hole = i;
+      }
+    }
+    m_Keys[hole] = EmptyKey;
+    --m_Size;
+    return true;
+  }
+
+private:
+  std::size_t Home(const Key& p_Key) const { return static_cast<std::size_t>(Hash{}(p_Key)) & m_Mask; }
+
+  void Rehash(std::size_t p_Capacity) {
+    std::vector<Key> keys(p_Capacity, EmptyKey);
+    std::vector<Value> values(p_Capacity);
+    keys.swap(m_Keys);
+    values.swap(m_Values);
+    m_Mask = p_Capacity - 1;
+    m_Size = 0;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      if (keys[i] != EmptyKey) Insert(keys[i], values[i]);
+    }
+  }
+
+  // Keys and values in parallel arrays, slot i in both: an 8-byte key with
+  // a 4-byte value (an order id and a pool index) takes 12 bytes instead of
+  // a padded 16, with both still naturally aligned. Probing only reads
+  // keys, so a probe run also stays on fewer cache lines.
+  std::vector<Key> m_Keys;
+  std::vector<Value> m_Values;
+  std::size_t m_Mask = 0;
+  std::size_t m_Size = 0;
+};
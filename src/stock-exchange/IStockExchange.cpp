@@ -1,6 +1,52 @@
 #include "IStockExchange.h"
+#include "ShardedStockExchange.h"
 #include "StockExchange.h"
 
-std::unique_ptr<IStockExchange> IStockExchange::Create() {
-  return std::make_unique<StockExchange>();
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace {
+
+// The ingest front end for an engine compiled for one instrument class.
+template<InstrumentClass Class>
+std::unique_ptr<IStockExchange> CreateFor(const EngineConfig& p_Config) {
+  using Engine = MatchingEngineFor<Class>;
+  switch (p_Config.ingest) {
+    case IngestMode::SPSC:
+      return std::make_unique<ShardedStockExchange<SpscInbox, Engine>>(p_Config);
+    case IngestMode::MPSC:
+      return std::make_unique<ShardedStockExchange<MpscInbox, Engine>>(p_Config);
+    case IngestMode::LOCKED:
+      return std::make_unique<ShardedStockExchange<LockedInbox, Engine>>(p_Config);
+    case IngestMode::SYNC:
+      break;
+  }
+  if (p_Config.shards > 1) return std::make_unique<ShardedStockExchange<LockedInbox, Engine>>(p_Config);
+  return std::make_unique<StockExchangeFor<Class>>(p_Config);
+}
+
+} // namespace
+
+// The only runtime choice of engine: once created, everything below the
+// virtual interface is compiled for the instrument class.
+std::unique_ptr<IStockExchange> IStockExchange::Create(const EngineConfig& p_Config) {
+  EngineConfig config = p_Config;
+  // symbols are hashed modulo the shard count
+  config.shards = std::max<std::size_t>(config.shards, 1);
+  switch (config.instruments) {
+    case InstrumentClass::EQUITY:
+      return CreateFor<InstrumentClass::EQUITY>(config);
+    case InstrumentClass::WIDE_RANGE:
+      return CreateFor<InstrumentClass::WIDE_RANGE>(config);
+    case InstrumentClass::PRO_RATA:
+      return CreateFor<InstrumentClass::PRO_RATA>(config);
+    case InstrumentClass::MIXED:
+      break;
+  }
+  return CreateFor<InstrumentClass::MIXED>(config);
+}
+
+void IStockExchange::ProcessBatch(std::span<Order> p_Orders) {
+  for (Order& order : p_Orders) Process(std::move(order));
 }
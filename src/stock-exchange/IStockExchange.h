@@ -1,28 +1,223 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+
+#include "Callback.h"
+#include "ExecutionReport.h"
+#include "Price.h"
+#include "Quote.h"
+#include "SymbolDirectory.h"
+
+struct BookSnapshot;
+struct LevelUpdate;
 
 struct Order {
-  enum class Operation {
+  enum class Operation : std::uint8_t {
     BUY, SELL
   };
 
   std::string symbol;
-  double price;
+  Price price;
   int volume;
   Operation operation;
+  // Fast path: set this (from IStockExchange::RegisterSymbol) and leave
+  // symbol empty to skip all string work. If it's kInvalidSymbol the book
+  // is looked up by symbol instead, and an order with neither is REJECTED.
+  SymbolId symbolId = kInvalidSymbol;
+  // echoed in this order's execution reports, and the handle for Cancel and
+  // Modify while it rests
+  OrderId id = kNoOrderId;
+};
+
+// How a symbol's price levels are stored.
+//   TREE: sorted tree of levels, any price range (default)
+//   FLAT: contiguous array indexed by tick, for liquid symbols that trade
+//         in a narrow band around the market
+enum class BookType {
+  TREE, FLAT
+};
+
+struct BookConfig {
+  BookType type = BookType::TREE;
+  std::int64_t priceScale = 100; // ticks per 1.0, see Price; must be positive
+  std::size_t levels = 4096;     // FLAT only, initial window width in ticks (0 counts as 1)
+  // FLAT only, the widest the window may grow. An order whose price is too
+  // far from its side's resting levels to fit is REJECTED.
+  std::size_t maxLevels = std::size_t{1} << 18;
+};
+
+// How callers hand orders to a matching thread.
+//   SYNC:   no handoff, match on the caller's thread (single shard only)
+//   LOCKED: mutex-guarded batch, any number of callers
+//   SPSC:   lock-free ring, exactly one caller thread
+//   MPSC:   lock-free bounded queue, any number of callers
+enum class IngestMode {
+  SYNC, LOCKED, SPSC, MPSC
+};
+
+// What kind of instruments an engine hosts. Each class gets an engine
+// compiled for it (book layout, queue layout and matching rule fixed at
+// compile time, see BookPolicy.h), so nothing in the matching loop is
+// chosen at runtime.
+//   MIXED:      per-symbol TREE/FLAT choice through ConfigureBook (default)
+//   EQUITY:     flat bitmap-indexed books, price-time priority
+//   WIDE_RANGE: tree books, price-time priority, for symbols whose prices
+//               roam too far for a tick-indexed window
+//   PRO_RATA:   flat books with ring queues, pro-rata allocation within a
+//               level (futures-style)
+enum class InstrumentClass {
+  MIXED, EQUITY, WIDE_RANGE, PRO_RATA
 };
 
-using TestCallback = std::function<void()>;
+// How the engine behind IStockExchange::Create is laid out.
+struct EngineConfig {
+  // 1: a single book owner. N > 1: symbols are hashed to N shards, each
+  // matching on its own thread. 0 counts as 1.
+  std::size_t shards = 1;
+  // SYNC with more than one shard means LOCKED
+  IngestMode ingest = IngestMode::SYNC;
+  std::size_t queueCapacity = 65536; // per shard, SPSC and MPSC
+  // execution report ring, per shard (see ReportStream)
+  std::size_t reportCapacity = 65536;
+  // how many more reports a consumer may fall behind by, per shard, before
+  // any are lost (see DroppedReports); reserved up front as more rings of
+  // reportCapacity, whose pages are only touched once a backlog reaches them
+  std::size_t reportBacklog = std::size_t{1} << 20;
+  // resting orders to size the order id index for up front, per shard
+  std::size_t expectedOrders = 1 << 20;
+  // back the resting order pools with huge pages (Linux only)
+  bool hugePages = false;
+  // pin shard i to core firstCore + i (Linux only)
+  bool pinThreads = true;
+  std::size_t firstCore = 0;
+  // which engine to compile-time specialize for, see InstrumentClass
+  InstrumentClass instruments = InstrumentClass::MIXED;
+  // symbols with a published Quote (ids 0 .. quoteSymbols - 1), one cache
+  // line each, per shard; the same ones get BookSnapshots if enabled
+  std::size_t quoteSymbols = 4096;
+  // levels per side in each BookSnapshot, 0 for none. Books changed by a
+  // batch are snapshotted after it, at O(levels) each.
+  std::size_t snapshotLevels = 0;
+  // L2 level update ring (see MarketData.h), per shard; 0 for no feed.
+  // Updates that don't fit are dropped, leaving sequence gaps, unless
+  // conflateFeed holds them back and merges them per level instead.
+  std::size_t feedCapacity = 0;
+  bool conflateFeed = false;
+};
+
+// Where a paged DisplayOrders stopped. Start from a default one and pass
+// back the one each page returns until it comes back done. Pages aren't a
+// snapshot: a book that changes between two pages shows its new state.
+struct DisplayCursor {
+  SymbolId symbol = 0;
+  bool asks = false;       // bids of symbol are done
+  std::uint32_t level = 0; // levels of the current side already written
+  Price last;              // the last of them, if level > 0
+  bool done = false;
+};
+
+// Which levels a paged DisplayOrders writes. Each is one text line,
+// "SYMBOL BUY|SELL PRICE VOLUME ORDERS\n", bids then asks, best first.
+struct DisplayQuery {
+  std::string_view symbol;              // empty: every symbol
+  std::optional<Order::Operation> side; // empty: both
+  std::size_t depth = 10;               // levels per side, from the best
+  DisplayCursor cursor;
+};
+
+// One page: the bytes written and where the next page starts.
+struct DisplayPage {
+  std::size_t size = 0;
+  DisplayCursor next;
+};
+
+using TestCallback = InplaceFunction<void()>;
+
+// Called on the matching thread once p_Order has been matched and any rest
+// of it booked, with the volume that traded. Stored in place, never
+// allocates.
+using CompletionCallback = InplaceFunction<void(const Order& p_Order, int p_Filled), 48>;
 
 class IStockExchange {
 public:
   // Factory function
-  static std::unique_ptr<IStockExchange> Create();
+  static std::unique_ptr<IStockExchange> Create(const EngineConfig& p_Config = {});
 
   virtual ~IStockExchange() {}
   virtual void Test(TestCallback p_Callback) = 0;
+  // Intern p_Symbol, returns the id to put in Order::symbolId;
+  // kInvalidSymbol for an empty name, which never gets a book.
+  virtual SymbolId RegisterSymbol(std::string_view p_Symbol) = 0;
+  // Choose the book layout for p_Symbol. Has no effect once the symbol has
+  // resting orders, or if p_Config.priceScale isn't positive. BookConfig::type only matters for MIXED engines, the
+  // other instrument classes have theirs built in. Sharded engines wait for
+  // the symbol's shard to apply it, so don't call it from a completion
+  // callback.
+  virtual void ConfigureBook(const std::string& p_Symbol, const BookConfig& p_Config) = 0;
+  // API edge conversion using p_Symbol's configured price scale.
+  virtual Price ToPrice(SymbolId p_Symbol, double p_Price) const = 0;
+  // Install the callback fired after each order. Set it before submitting
+  // orders; threaded engines call it from their matching threads.
+  virtual void SetCompletionCallback(CompletionCallback p_Callback) = 0;
   virtual void Process(Order&& p_Order) = 0;
+  // Pull a resting order out of its book. p_Symbol is the order's symbol,
+  // as on the wire: sharded engines route by it. REJECTED if no order p_Id
+  // rests under p_Symbol.
+  virtual void Cancel(SymbolId p_Symbol, OrderId p_Id) = 0;
+  // Change a resting order's volume and price. Reducing the volume at the
+  // same price is done in place and keeps the order's queue position; a
+  // price change or a volume increase loses time priority and is matched
+  // again at the new price. p_Symbol as for Cancel.
+  virtual void Modify(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice) = 0;
+  // Same as calling Process on each order in turn, but in one call so the
+  // engine can amortize dispatch and regroup the burst by symbol. Orders for
+  // the same symbol keep their relative order. The orders are moved from.
+  virtual void ProcessBatch(std::span<Order> p_Orders);
+  // Hand up to p_Max pending execution reports to p_Consume, oldest first,
+  // and return how many there were. Call from one consumer thread; safe to
+  // run while orders are being matched.
+  virtual std::size_t DrainReports(FunctionRef<void(const ExecutionReport&)> p_Consume,
+                                   std::size_t p_Max = SIZE_MAX) = 0;
+  // Execution reports lost so far to a consumer that fell further behind
+  // than EngineConfig::reportBacklog; the gap shows in their sequence
+  // numbers. Any thread.
+  virtual std::uint64_t DroppedReports() const = 0;
+  // Print the top levels of every book (price, total volume, order count)
+  // to stdout. Sharded engines match on their own threads and show each
+  // side of a book as of its latest BookSnapshot, so they print nothing
+  // here, nor write anything in the overloads below, without
+  // EngineConfig::snapshotLevels.
   virtual void DisplayOrders() = 0;
+  // Write as many whole lines of what p_Query selects into p_Buffer as fit;
+  // nothing if not even one does. Integer formatting only, no locale and
+  // no iostreams; a book's lines cost O(depth) however many orders rest.
+  virtual DisplayPage DisplayOrders(const DisplayQuery& p_Query, std::span<char> p_Buffer) = 0;
+  // All of it from p_Query.cursor on, handed to p_Sink in chunks of a few
+  // KB.
+  virtual void DisplayOrders(const DisplayQuery& p_Query, FunctionRef<void(std::string_view)> p_Sink) = 0;
+  // p_Symbol's top of book and last trade as of the last order that changed
+  // them. Any thread, any number of them: no lock, and the matcher never
+  // waits on readers. Empty past EngineConfig::quoteSymbols.
+  virtual std::optional<Quote> ReadQuote(SymbolId p_Symbol) const = 0;
+  // p_Read(snapshot) on p_Symbol's latest BookSnapshot, taken at the end of
+  // the batch that last changed the book (see EngineConfig::snapshotLevels).
+  // Any thread: the snapshot stays valid while p_Read runs, without
+  // stopping the matcher, and is reused only after. false, without calling
+  // p_Read, if there is none.
+  virtual bool ReadSnapshot(SymbolId p_Symbol, FunctionRef<void(const BookSnapshot&)> p_Read) const = 0;
+  // Hand up to p_Max pending level updates (EngineConfig::feedCapacity) to
+  // p_Consume, oldest first, and return how many there were. Call from one
+  // consumer thread; the matcher never waits for it. With conflateFeed,
+  // levels held back for room go out as this drains, matcher busy or not.
+  // Sharded engines drain shard by shard, so updates are in order per
+  // symbol.
+  virtual std::size_t DrainMarketData(FunctionRef<void(const LevelUpdate&)> p_Consume,
+                                      std::size_t p_Max = SIZE_MAX) = 0;
 };
 
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CacheLine.h"
+#include "Command.h"
+#include "MpscQueue.h"
+#include "SpscRing.h"
+
+// Handoffs from caller threads to a matching thread. Each provides:
+//   Post(Command&&)             caller side, returns once the command is queued
+//   Drain(F)                    matcher side, calls F(Command&) per command
+//   Idle(const atomic<bool>&)   matcher side, wait a little for more work
+//   Wake()                      caller side, end an Idle early
+
+// Any number of callers. The lock only guards the pending vector; the
+// matcher swaps it out and processes the batch without holding it, and
+// sleeps on a condition variable when there is nothing to do.
+class LockedInbox {
+public:
+  explicit LockedInbox(std::size_t /*p_Capacity*/) {}
+
+  void Post(Command&& p_Command) {
+    bool wasEmpty;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      wasEmpty = m_Pending.empty();
+      m_Pending.push_back(std::move(p_Command));
+    }
+    if (wasEmpty) m_WakeUp.notify_one();
+  }
+
+  template<typename F>
+  std::size_t Drain(F&& p_Consume) {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Batch.swap(m_Pending);
+    }
+    for (Command& command : m_Batch) p_Consume(command);
+    std::size_t count = m_Batch.size();
+    m_Batch.clear();
+    return count;
+  }
+
+  void Idle(const std::atomic<bool>& p_Stopping) {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_WakeUp.wait(lock, [&]() { return p_Stopping.load() || !m_Pending.empty(); });
+  }
+
+  void Wake() {
+    { std::lock_guard<std::mutex> lock(m_Mutex); }
+    m_WakeUp.notify_one();
+  }
+
+private:
+  std::mutex m_Mutex;
+  std::condition_variable m_WakeUp;
+  std::vector<Command> m_Pending;
+  std::vector<Command> m_Batch; // matcher only
+};
+
+// Caller-side wait for a full queue: spin briefly, then give the core away
+// in case the matcher is waiting for it.
+inline void Backoff(int p_Spins) {
+  if (p_Spins < 64) {
+    CpuRelax();
+  } else {
+    std::this_thread::yield();
+  }
+}
+
+// Exactly one caller thread. Lock- and allocation-free: commands are moved
+// into preallocated ring slots, and both sides spin instead of sleeping. A
+// full ring pushes back on the caller.
+class SpscInbox {
+public:
+  explicit SpscInbox(std::size_t p_Capacity) : m_Ring(p_Capacity) {}
+
+  void Post(Command&& p_Command) {
+    for (int spins = 0; !m_Ring.TryPush(std::move(p_Command)); ++spins) Backoff(spins);
+  }
+
+  template<typename F>
+  std::size_t Drain(F&& p_Consume) { return m_Ring.Drain(p_Consume); }
+
+  void Idle(const std::atomic<bool>& /*p_Stopping*/) {
+    for (int i = 0; i < 64 && m_Ring.Empty(); ++i) CpuRelax();
+    if (m_Ring.Empty()) std::this_thread::yield();
+  }
+
+  void Wake() {}
+
+private:
+  SpscRing<Command> m_Ring;
+};
+
+// Any number of caller threads, lock-free. Callers claim slots with a CAS
+// instead of queueing on a mutex; the matcher drains in batches and spins
+// while idle. A full queue pushes back on the callers.
+class MpscInbox {
+public:
+  explicit MpscInbox(std::size_t p_Capacity) : m_Queue(p_Capacity) {}
+
+  void Post(Command&& p_Command) {
+    for (int spins = 0; !m_Queue.TryPush(std::move(p_Command)); ++spins) Backoff(spins);
+  }
+
+  template<typename F>
+  std::size_t Drain(F&& p_Consume) { return m_Queue.Drain(p_Consume, kMaxBatch); }
+
+  void Idle(const std::atomic<bool>& /*p_Stopping*/) {
+    for (int i = 0; i < 64 && m_Queue.Empty(); ++i) CpuRelax();
+    if (m_Queue.Empty()) std::this_thread::yield();
+  }
+
+  void Wake() {}
+
+private:
+  // bounds how long producers wait for freed slots behind a long drain
+  static constexpr std::size_t kMaxBatch = 256;
+
+  MpscQueue<Command> m_Queue;
+};
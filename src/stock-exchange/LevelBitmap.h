@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per price level, set while the level has orders, plus summary
+// layers on top where each bit says "some bit in this 64-bit word below is
+// set". Finding the next non-empty level from anywhere is a ctz/clz per
+// layer (two layers for 4096 levels, three up to 262144) no matter how many
+// empty levels lie in between.
+class LevelBitmap {
+public:
+  explicit LevelBitmap(std::size_t p_Bits = 0) { Resize(p_Bits); }
+
+  static constexpr long kNone = -1;
+
+  // clears everything
+  void Resize(std::size_t p_Bits) {
+    m_Layers.clear();
+    std::size_t words = WordsFor(p_Bits);
+    do {
+      m_Layers.emplace_back(words, 0);
+      words = WordsFor(words);
+    } while (m_Layers.back().size() > 1);
+  }
+
+  bool Test(std::size_t p_Bit) const {
+    return m_Layers[0][p_Bit >> 6] >> (p_Bit & 63) & 1;
+  }
+
+  void Set(std::size_t p_Bit) {
+    for (std::vector<std::uint64_t>& layer : m_Layers) {
+      std::uint64_t& word = layer[p_Bit >> 6];
+      bool wasEmpty = word == 0;
+      word |= std::uint64_t{1} << (p_Bit & 63);
+      if (!wasEmpty) return; // the layers above already know
+      p_Bit >>= 6;
+    }
+  }
+
+  void Clear(std::size_t p_Bit) {
+    for (std::vector<std::uint64_t>& layer : m_Layers) {
+      std::uint64_t& word = layer[p_Bit >> 6];
+      word &= ~(std::uint64_t{1} << (p_Bit & 63));
+      if (word != 0) return; // still non-empty, the layers above stay set
+      p_Bit >>= 6;
+    }
+  }
+
+  // lowest set bit >= p_From, or kNone
+  long Next(long p_From) const {
+    if (p_From < 0) p_From = 0;
+    std::size_t bit = static_cast<std::size_t>(p_From);
+    std::size_t layer = 0;
+    // climb until some word has a set bit at or after our position
+    for (;; ++layer) {
+      if (layer == m_Layers.size()) return kNone;
+      std::size_t word = bit >> 6;
+      if (word >= m_Layers[layer].size()) return kNone;
+      std::uint64_t masked = m_Layers[layer][word] & (~std::uint64_t{0} << (bit & 63));
+      if (masked) {
+        bit = (word << 6) | static_cast<std::size_t>(__builtin_ctzll(masked));
+        break;
+      }
+      bit = word + 1; // nothing left in this word, continue after it one layer up
+    }
+    // then take the lowest set bit all the way down
+    while (layer-- > 0) {
+      bit = (bit << 6) | static_cast<std::size_t>(__builtin_ctzll(m_Layers[layer][bit]));
+    }
+    return static_cast<long>(bit);
+  }
+
+  // highest set bit <= p_From, or kNone
+  long Prev(long p_From) const {
+    if (p_From < 0) return kNone;
+    std::size_t bit = static_cast<std::size_t>(p_From);
+    std::size_t layer = 0;
+    for (;; ++layer) {
+      if (layer == m_Layers.size()) return kNone;
+      std::size_t word = bit >> 6;
+      if (word >= m_Layers[layer].size()) {
+        // past the end: start from the last word of this layer
+        word = m_Layers[layer].size() - 1;
+        bit = (word << 6) | 63;
+      }
+      std::uint64_t masked = m_Layers[layer][word] & (~std::uint64_t{0} >> (63 - (bit & 63)));
+      if (masked) {
+        bit = (word << 6) | static_cast<std::size_t>(63 - __builtin_clzll(masked));
+        break;
+      }
+      if (word == 0) return kNone;
+      bit = word - 1;
+    }
+    while (layer-- > 0) {
+      bit = (bit << 6) | static_cast<std::size_t>(63 - __builtin_clzll(m_Layers[layer][bit]));
+    }
+    return static_cast<long>(bit);
+  }
+
+private:
+  static std::size_t WordsFor(std::size_t p_Bits) { return p_Bits == 0 ? 1 : (p_Bits + 63) / 64; }
+
+  // [0] is one bit per level, each next layer summarizes the one below
+  std::vector<std::vector<std::uint64_t>> m_Layers;
+};
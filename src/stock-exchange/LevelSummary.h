@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "Price.h"
+
+// One price level as market data sees it: the total volume resting there
+// and how many orders make it up. Levels keep both up to date as orders
+// rest, fill, shrink and cancel, so reading one is O(1) however deep the
+// queue is.
+struct LevelSummary {
+  Price price;
+  std::int64_t volume = 0;
+  std::uint32_t orders = 0;
+};
+
+// Hand p_Level to a Depth callback. Callbacks return void, or bool with
+// false meaning "stop here"; returns whether to go on.
+template<typename Fn>
+bool VisitLevel(Fn& p_Fn, const LevelSummary& p_Level) {
+  if constexpr (std::is_void_v<std::invoke_result_t<Fn&, const LevelSummary&>>) {
+    p_Fn(p_Level);
+    return true;
+  } else {
+    return p_Fn(p_Level);
+  }
+}
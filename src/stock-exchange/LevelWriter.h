@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "Callback.h"
+#include "IStockExchange.h"
+#include "LevelSummary.h"
+#include "Price.h"
+
+// Formats depth lines ("SYMBOL SIDE PRICE VOLUME ORDERS\n") straight into a
+// caller's buffer with std::to_chars: no locale, no stream state, no
+// allocation. A line that doesn't fit isn't written at all, so the buffer
+// always ends on a whole line.
+class LevelWriter {
+public:
+  explicit LevelWriter(std::span<char> p_Buffer)
+    : m_Begin(p_Buffer.data()), m_Pos(p_Buffer.data()), m_End(p_Buffer.data() + p_Buffer.size()) {}
+
+  std::size_t Size() const { return static_cast<std::size_t>(m_Pos - m_Begin); }
+
+  // Decimal places of a price scale: 2 for 100. -1 if it isn't a power of
+  // ten, and prices go through double instead.
+  static int Decimals(std::int64_t p_Scale) {
+    int decimals = 0;
+    for (; p_Scale > 1 && p_Scale % 10 == 0; p_Scale /= 10) ++decimals;
+    return p_Scale == 1 ? decimals : -1;
+  }
+
+  // false, with nothing written, if the line doesn't fit
+  bool Line(std::string_view p_Symbol, Order::Operation p_Side, const LevelSummary& p_Level, std::int64_t p_Scale,
+            int p_Decimals) {
+    char* pos = m_Pos;
+    bool fits = Put(pos, p_Symbol) && Put(pos, p_Side == Order::Operation::BUY ? " BUY " : " SELL ") &&
+                PutPrice(pos, p_Level.price, p_Scale, p_Decimals) && Put(pos, " ") && PutInt(pos, p_Level.volume) &&
+                Put(pos, " ") && PutInt(pos, p_Level.orders) && Put(pos, "\n");
+    if (fits) m_Pos = pos;
+    return fits;
+  }
+
+private:
+  bool Put(char*& p_Pos, std::string_view p_Text) const {
+    if (static_cast<std::size_t>(m_End - p_Pos) < p_Text.size()) return false;
+    std::memcpy(p_Pos, p_Text.data(), p_Text.size());
+    p_Pos += p_Text.size();
+    return true;
+  }
+
+  template<typename Int>
+  bool PutInt(char*& p_Pos, Int p_Value) const {
+    auto [end, error] = std::to_chars(p_Pos, m_End, p_Value);
+    if (error != std::errc{}) return false;
+    p_Pos = end;
+    return true;
+  }
+
+  // ticks / scale, exactly, with all p_Decimals places ("100.10")
+  bool PutPrice(char*& p_Pos, Price p_Price, std::int64_t p_Scale, int p_Decimals) const {
+    if (p_Decimals < 0) {
+      auto [end, error] = std::to_chars(p_Pos, m_End, p_Price.ToDouble(p_Scale));
+      if (error != std::errc{}) return false;
+      p_Pos = end;
+      return true;
+    }
+    std::int64_t whole = p_Price.ticks / p_Scale;
+    std::int64_t fraction = p_Price.ticks % p_Scale;
+    if (fraction < 0) fraction = -fraction;
+    // -0.50 has no sign left in its whole part
+    if (p_Price.ticks < 0 && whole == 0 && !Put(p_Pos, "-")) return false;
+    if (!PutInt(p_Pos, whole)) return false;
+    if (p_Decimals == 0) return true;
+    if (static_cast<std::size_t>(m_End - p_Pos) < static_cast<std::size_t>(p_Decimals) + 1) return false;
+    *p_Pos++ = '.';
+    for (int i = p_Decimals - 1; i >= 0; --i, fraction /= 10) p_Pos[i] = static_cast<char>('0' + fraction % 10);
+    p_Pos += p_Decimals;
+    return true;
+  }
+
+  char* m_Begin;
+  char* m_Pos;
+  char* m_End;
+};
+
+// The paged walk behind DisplayOrders, over any engine's books: symbols,
+// then bids and asks, then levels, resuming at p_Query's cursor right
+// after the last level written, found by price, so a page costs what it
+// writes and never re-walks earlier pages. Books provides
+//   SymbolId Size(), SymbolId Find(std::string_view),
+//   std::string_view Name(SymbolId), std::int64_t PriceScale(SymbolId),
+//   Depth(SymbolId, side, max, fn, after) as in OrderBook::Depth.
+template<typename Books>
+DisplayPage WriteDepthPage(const DisplayQuery& p_Query, std::span<char> p_Buffer, const Books& p_Books) {
+  LevelWriter writer(p_Buffer);
+  DisplayCursor cursor = p_Query.cursor;
+  SymbolId end = p_Books.Size();
+  if (!p_Query.symbol.empty()) {
+    SymbolId only = p_Books.Find(p_Query.symbol);
+    if (only == kInvalidSymbol) only = end; // nothing to show
+    if (cursor.symbol < only) {
+      cursor = DisplayCursor{};
+      cursor.symbol = only;
+    }
+    end = std::min(end, only + 1);
+  }
+
+  for (; cursor.symbol < end; ++cursor.symbol, cursor.asks = false, cursor.level = 0) {
+    std::string_view name = p_Books.Name(cursor.symbol);
+    std::int64_t scale = p_Books.PriceScale(cursor.symbol);
+    int decimals = LevelWriter::Decimals(scale);
+    // false once the buffer is full
+    auto writeSide = [&](Order::Operation p_Side) {
+      if (p_Query.side && *p_Query.side != p_Side) return true;
+      if (cursor.level >= p_Query.depth) return true;
+      bool full = false;
+      std::optional<Price> after;
+      if (cursor.level > 0) after = cursor.last;
+      p_Books.Depth(cursor.symbol, p_Side, p_Query.depth - cursor.level, [&](const LevelSummary& p_Level) {
+        full = !writer.Line(name, p_Side, p_Level, scale, decimals);
+        if (full) return false;
+        ++cursor.level;
+        cursor.last = p_Level.price;
+        return true;
+      }, after);
+      return !full;
+    };
+
+    if (!cursor.asks) {
+      if (!writeSide(Order::Operation::BUY)) return DisplayPage{writer.Size(), cursor};
+      cursor.asks = true;
+      cursor.level = 0;
+    }
+    if (!writeSide(Order::Operation::SELL)) return DisplayPage{writer.Size(), cursor};
+  }
+  cursor.done = true;
+  return DisplayPage{writer.Size(), cursor};
+}
+
+// All of it from p_Query.cursor on, a page at a time through a 4 KB buffer.
+template<typename Books>
+void WriteDepth(const DisplayQuery& p_Query, const Books& p_Books, FunctionRef<void(std::string_view)> p_Sink) {
+  std::array<char, 4096> buffer;
+  DisplayQuery query = p_Query;
+  while (!query.cursor.done) {
+    DisplayPage page = WriteDepthPage(query, std::span<char>(buffer), p_Books);
+    // a line longer than the whole buffer would never fit
+    if (page.size == 0 && !page.next.done) break;
+    p_Sink(std::string_view(buffer.data(), page.size));
+    query.cursor = page.next;
+  }
+}
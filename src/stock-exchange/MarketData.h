@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Callback.h"
+#include "FlatHashMap.h"
+#include "IStockExchange.h"
+#include "Price.h"
+#include "SpscRing.h"
+#include "SymbolDirectory.h"
+
+// One price level changed (L2, full depth). A book's updates come out per
+// batch: whatever happened to a level within it, it gets at most one update
+// carrying the level as the batch left it.
+struct LevelUpdate {
+  enum class Action : std::uint8_t {
+    ADD, UPDATE, DELETE
+  };
+
+  // per symbol, from 1. A jump means updates to the symbol were lost (see
+  // MarketDataFeed); its book is to be rebuilt, e.g. from ReadSnapshot.
+  std::uint64_t sequence = 0;
+  Price price;
+  std::int64_t volume = 0;  // 0 for DELETE
+  std::uint32_t orders = 0; // 0 for DELETE
+  SymbolId symbol = kInvalidSymbol;
+  Order::Operation side = Order::Operation::BUY;
+  Action action = Action::ADD;
+};
+
+// Where a LevelUpdate applies, as a hash key.
+struct LevelKey {
+  Price price;
+  SymbolId symbol = kInvalidSymbol; // kInvalidSymbol: a free slot
+  Order::Operation side = Order::Operation::BUY;
+
+  bool operator==(const LevelKey&) const = default;
+};
+
+struct LevelKeyHash {
+  std::uint64_t operator()(const LevelKey& p_Key) const {
+    std::uint64_t ticks = static_cast<std::uint64_t>(p_Key.price.ticks);
+    std::uint64_t where = std::uint64_t{p_Key.symbol} << 1 | static_cast<std::uint64_t>(p_Key.side);
+    return IntegerHash{}(ticks * 0x9e3779b97f4a7c15ull ^ where);
+  }
+};
+
+// Level updates from one matching thread to one consumer thread, through a
+// preallocated SPSC ring. The matcher Publish()es a batch's updates and
+// Flush()es them; it never waits for the consumer. When the ring is full:
+//   gaps (default): what doesn't fit is dropped, and the symbols' sequence
+//     numbers show the consumer where.
+//   conflation: what doesn't fit is held, one slot per level, and a later
+//     update to a held level overwrites its slot in O(1) (an ADD then a
+//     DELETE cancel out). Held levels go out oldest first as the ring
+//     frees up, so a busy symbol can't keep a quiet one waiting. Nothing is
+//     lost, the consumer gets the latest state of each level once it
+//     catches up, and what's held is bounded by the number of levels, not
+//     by the length of the burst. The consumer's Drain releases held levels
+//     itself, so they don't wait for a matcher that may have nothing more
+//     to do; a mutex hands the held levels, and the ring's producer side,
+//     between the two. The matcher takes it once per Flush, and the
+//     consumer only while something is held.
+class MarketDataFeed {
+public:
+  // p_Capacity 0: no feed at all
+  MarketDataFeed(std::size_t p_Capacity, bool p_Conflate)
+    : m_Ring(p_Capacity > 0 ? std::make_unique<SpscRing<LevelUpdate>>(p_Capacity) : nullptr),
+      m_Conflate(p_Conflate) {
+    if (m_Ring && m_Conflate) {
+      m_Out.reserve(m_Ring->Capacity());
+      m_Held.resize(kHeldSlots);
+    }
+  }
+
+  bool Enabled() const { return m_Ring != nullptr; }
+
+  // Matcher only. The next update of the batch, at most one per level.
+  void Publish(const LevelUpdate& p_Update) { m_Batch.push_back(p_Update); }
+
+  // Matcher only. Sends the batch, or as much of it as fits; also retries
+  // what's held.
+  void Flush() {
+    if (!m_Conflate) {
+      if (!m_Batch.empty()) m_Ring->TryPushSome(Stamp(m_Batch.data(), m_Batch.size()), m_Batch.size());
+      m_Batch.clear();
+      return;
+    }
+    std::lock_guard<std::mutex> lock(m_HeldMutex);
+    if (m_HeldHead == m_HeldTail) {
+      // nothing held: straight through, holding only what doesn't fit
+      std::size_t fits = std::min(m_Ring->Space(), m_Batch.size());
+      m_Ring->TryPushSome(Stamp(m_Batch.data(), fits), fits);
+      for (std::size_t i = fits; i < m_Batch.size(); ++i) Hold(m_Batch[i]);
+    } else {
+      // behind the held levels, so nothing overtakes them
+      for (const LevelUpdate& update : m_Batch) Hold(update);
+      Release();
+    }
+    m_Batch.clear();
+    m_Holding.store(m_HeldHead != m_HeldTail, std::memory_order_release);
+  }
+
+  // Consumer only. Hands up to p_Max updates to p_Consume, oldest first,
+  // sending held levels as it makes room for them.
+  std::size_t Drain(FunctionRef<void(const LevelUpdate&)> p_Consume, std::size_t p_Max) {
+    if (!m_Ring) return 0;
+    auto consume = [&](LevelUpdate& p_Update) { p_Consume(p_Update); };
+    std::size_t count = m_Ring->Drain(consume, p_Max);
+    while (count < p_Max && m_Holding.load(std::memory_order_acquire)) {
+      {
+        std::lock_guard<std::mutex> lock(m_HeldMutex);
+        Release();
+        m_Holding.store(m_HeldHead != m_HeldTail, std::memory_order_relaxed);
+      }
+      std::size_t more = m_Ring->Drain(consume, p_Max - count);
+      if (more == 0) break;
+      count += more;
+    }
+    return count;
+  }
+
+private:
+  // A held level, in a FIFO of slots: live if it still has something to
+  // send (an ADD and then a DELETE leave it dead until it's touched again).
+  struct Held {
+    LevelUpdate update;
+    bool live = false;
+  };
+
+  static constexpr std::size_t kHeldSlots = 64;
+
+  static LevelKey KeyOf(const LevelUpdate& p_Update) { return LevelKey{p_Update.price, p_Update.symbol, p_Update.side}; }
+
+  // Number p_Count updates in order, per symbol.
+  const LevelUpdate* Stamp(LevelUpdate* p_Updates, std::size_t p_Count) {
+    for (std::size_t i = 0; i < p_Count; ++i) {
+      LevelUpdate& update = p_Updates[i];
+      if (update.symbol >= m_Sequences.size()) m_Sequences.resize(update.symbol + 1, 0);
+      update.sequence = ++m_Sequences[update.symbol];
+    }
+    return p_Updates;
+  }
+
+  // Overwrite p_Update's level in its slot, or hold it in a new one at the
+  // back.
+  void Hold(const LevelUpdate& p_Update) {
+    if (std::uint64_t* position = m_Slots.Find(KeyOf(p_Update))) {
+      Held& held = m_Held[*position & (m_Held.size() - 1)];
+      // the consumer still has the state before the held update, so the
+      // action is relative to that
+      using Action = LevelUpdate::Action;
+      Action was = held.update.action;
+      bool live = held.live;
+      held.update = p_Update;
+      held.live = true;
+      if (!live) return;
+      if (was == Action::ADD && p_Update.action == Action::DELETE) held.live = false; // never seen, already gone
+      if (was == Action::ADD) held.update.action = Action::ADD;
+      if (was == Action::DELETE && p_Update.action == Action::ADD) held.update.action = Action::UPDATE;
+      return;
+    }
+    if (m_HeldTail - m_HeldHead == m_Held.size()) Grow();
+    m_Held[m_HeldTail & (m_Held.size() - 1)] = Held{p_Update, true};
+    m_Slots.Insert(KeyOf(p_Update), m_HeldTail++);
+  }
+
+  // Send held levels from the front, as many as the ring has room for.
+  void Release() {
+    std::size_t space = m_Ring->Space();
+    m_Out.clear();
+    while (m_HeldHead != m_HeldTail && m_Out.size() < space) {
+      const Held& held = m_Held[m_HeldHead++ & (m_Held.size() - 1)];
+      m_Slots.Erase(KeyOf(held.update));
+      if (held.live) m_Out.push_back(held.update);
+    }
+    m_Ring->TryPushSome(Stamp(m_Out.data(), m_Out.size()), m_Out.size());
+  }
+
+  // Double the held FIFO; positions keep naming the same slots, as in
+  // RingLevel.
+  void Grow() {
+    std::vector<Held> held(2 * m_Held.size());
+    for (std::uint64_t i = m_HeldHead; i != m_HeldTail; ++i) {
+      held[i & (held.size() - 1)] = m_Held[i & (m_Held.size() - 1)];
+    }
+    m_Held.swap(held);
+  }
+
+  std::unique_ptr<SpscRing<LevelUpdate>> m_Ring;
+  bool m_Conflate;
+  std::vector<std::uint64_t> m_Sequences;
+  // the batch being published
+  std::vector<LevelUpdate> m_Batch;
+  // conflation only, under m_HeldMutex along with the ring's producer side
+  // and m_Sequences: levels waiting for room in the ring, oldest first, at
+  // positions [m_HeldHead, m_HeldTail); each one's position by level; and
+  // scratch for what Release sends. m_Holding says whether any are held,
+  // so a consumer that's caught up doesn't take the lock.
+  std::mutex m_HeldMutex;
+  std::atomic<bool> m_Holding{false};
+  std::vector<Held> m_Held;
+  std::uint64_t m_HeldHead = 0;
+  std::uint64_t m_HeldTail = 0;
+  FlatHashMap<LevelKey, std::uint64_t, LevelKey{}, LevelKeyHash> m_Slots;
+  std::vector<LevelUpdate> m_Out;
+};
@@ -0,0 +1,576 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "BookPolicy.h"
+#include "BookSnapshot.h"
+#include "Callback.h"
+#include "Command.h"
+#include "ExecutionReport.h"
+#include "FlatHashMap.h"
+#include "IStockExchange.h"
+#include "LevelSummary.h"
+#include "LevelWriter.h"
+#include "MarketData.h"
+#include "OrderBook.h"
+#include "PriceLevel.h"
+#include "Quote.h"
+#include "StaticExchange.h"
+#include "SymbolDirectory.h"
+
+// Single-threaded matching engine, compiled for one BookPolicy: all books
+// are Policy::Book, so the matching loop is specialized for that layout and
+// rule. Its operations are the StaticExchange ones; embedders can hold one
+// directly and get every call resolved (and inlined) at compile time.
+// BasicStockExchange puts it behind IStockExchange, and sharded engines run
+// one per shard.
+template<typename Policy>
+class MatchingEngine : public StaticExchange<MatchingEngine<Policy>> {
+public:
+  explicit MatchingEngine(const EngineConfig& p_Config = {});
+
+  // Run a command handed over by a queued front end. Its reports, and the
+  // market data of the books it changed, wait for Flush, so a front end can
+  // flush once per batch.
+  void Apply(Command&& p_Command);
+  // Hand staged reports to the consumer, then snapshots and level updates
+  // of the books changed since the last Flush.
+  void Flush();
+
+private:
+  friend class StaticExchange<MatchingEngine>;
+
+  using Book = typename Policy::Book;
+  using Level = typename Policy::Level;
+  using Handle = typename Level::Handle;
+  using Storage = typename Level::Storage;
+
+  // one resting order hit by the current aggressor
+  struct Fill {
+    OrderId resting;
+    Price price;
+    int quantity;
+    int restingLeaves;
+  };
+
+  // a level changed since the last Flush, and whether it had orders
+  // before; the first touch of a level (lowest order) has the answer for
+  // the consumer
+  struct Touch {
+    SymbolId symbol;
+    Order::Operation side;
+    Price price;
+    bool existed;
+    std::uint32_t order = 0;
+  };
+
+  SymbolId RegisterSymbolImpl(std::string_view p_Symbol);
+  // false if the book kept its config: it has resting orders
+  bool ConfigureBookImpl(const std::string& p_Symbol, const BookConfig& p_Config);
+  Price ToPriceImpl(SymbolId p_Symbol, double p_Price) const;
+  void SetCompletionCallbackImpl(CompletionCallback p_Callback);
+  void ProcessImpl(Order&& p_Order);
+  void CancelImpl(SymbolId p_Symbol, OrderId p_Id);
+  void ModifyImpl(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice);
+  void ProcessBatchImpl(std::span<Order> p_Orders);
+  std::size_t DrainReportsImpl(FunctionRef<void(const ExecutionReport&)> p_Consume, std::size_t p_Max);
+  std::uint64_t DroppedReportsImpl() const { return m_Reports.Dropped(); }
+  void DisplayOrdersImpl();
+  DisplayPage DisplayOrdersImpl(const DisplayQuery& p_Query, std::span<char> p_Buffer);
+  void DisplayOrdersImpl(const DisplayQuery& p_Query, FunctionRef<void(std::string_view)> p_Sink);
+  std::optional<Quote> ReadQuoteImpl(SymbolId p_Symbol) const { return m_Quotes.Read(p_Symbol); }
+  bool ReadSnapshotImpl(SymbolId p_Symbol, FunctionRef<void(const BookSnapshot&)> p_Read) const {
+    return m_Snapshots.Read(p_Symbol, p_Read);
+  }
+  std::size_t DrainMarketDataImpl(FunctionRef<void(const LevelUpdate&)> p_Consume, std::size_t p_Max) {
+    return m_Feed.Drain(p_Consume, p_Max);
+  }
+
+  // the books as WriteDepthPage walks them, read in place
+  struct LiveBooks {
+    const MatchingEngine& engine;
+
+    SymbolId Size() const { return static_cast<SymbolId>(engine.m_Books.size()); }
+    SymbolId Find(std::string_view p_Symbol) const { return engine.m_Symbols.Find(p_Symbol); }
+    std::string_view Name(SymbolId p_Symbol) const { return engine.m_Symbols.Name(p_Symbol); }
+    std::int64_t PriceScale(SymbolId p_Symbol) const { return engine.m_Configs[p_Symbol].priceScale; }
+
+    template<typename Fn>
+    void Depth(SymbolId p_Symbol, Order::Operation p_Side, std::size_t p_Max, Fn&& p_Fn,
+               std::optional<Price> p_After) const {
+      VisitBook(engine.m_Books[p_Symbol], [&](const auto& p_Book) { p_Book.Depth(p_Side, p_Max, p_Fn, p_After); });
+    }
+  };
+
+  SymbolId Resolve(const Order& p_Order);
+  void Match(const Order& p_Order);
+  void MatchBatch(std::span<Order> p_Orders);
+  template<typename BookT>
+  void Match(BookT& p_Book, SymbolId p_Symbol, const Order& p_Order,
+             ExecutionReport::Type p_Ack = ExecutionReport::Type::NEW);
+  // the handle of the order p_Id resting in p_Symbol's book, or nullptr
+  Handle* FindOrder(SymbolId p_Symbol, OrderId p_Id);
+  void CancelOrder(SymbolId p_Symbol, OrderId p_Id);
+  void ModifyOrder(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice);
+  void PublishFills(const Order& p_Order, SymbolId p_Symbol);
+  template<typename BookT>
+  void BookChanged(const BookT& p_Book, SymbolId p_Symbol);
+  void PublishSnapshots();
+  void PublishLevels();
+  RestingOrder Resting(const Handle& p_Handle);
+  void Unlink(const Handle& p_Handle);
+  void Reject(const Order& p_Order);
+
+  SymbolDirectory m_Symbols;
+  // resting orders of every book (the node pool for PriceLevel books),
+  // reused for the whole session
+  Storage m_Storage;
+  // one price-time priority book per symbol, indexed by SymbolId
+  std::vector<Book> m_Books;
+  std::vector<BookConfig> m_Configs;
+  // every resting order with an id, across all books; the handle says
+  // which book, side and price
+  FlatHashMap<OrderId, Handle, kNoOrderId> m_Orders;
+  // RestingOrder::timestamp source
+  std::uint32_t m_Clock = 0;
+  CompletionCallback m_OnComplete;
+  ReportStream m_Reports;
+  // every symbol's top of book, for readers on other threads
+  QuoteBoard m_Quotes;
+  // and full-depth views, when configured: the books changed since the
+  // last Flush (each flagged once) get a new snapshot there
+  SnapshotBoard m_Snapshots;
+  std::vector<SymbolId> m_Changed;
+  std::vector<std::uint8_t> m_ChangedFlags;
+  // and level by level, when configured: the levels touched since the last
+  // Flush, in the order they were, duplicates and all
+  MarketDataFeed m_Feed;
+  std::vector<Touch> m_Touched;
+
+  // ProcessBatch scratch, (book, position in batch); kept to reuse capacity
+  std::vector<std::pair<SymbolId, std::uint32_t>> m_BatchOrder;
+  // Match scratch: the fills of one aggressor, turned into reports once the
+  // sweep is done
+  std::vector<Fill> m_Fills;
+};
+
+// the engine compiled for an instrument class
+template<InstrumentClass Class>
+using MatchingEngineFor = MatchingEngine<typename PolicyFor<Class>::type>;
+
+template<typename Policy>
+MatchingEngine<Policy>::MatchingEngine(const EngineConfig& p_Config)
+  : m_Storage(MakeStorage<Storage>(p_Config)), m_Orders(p_Config.expectedOrders),
+    m_Reports(p_Config.reportCapacity, p_Config.reportBacklog), m_Quotes(p_Config.quoteSymbols),
+    m_Snapshots(p_Config.quoteSymbols, p_Config.snapshotLevels),
+    m_ChangedFlags(m_Snapshots.Enabled() ? p_Config.quoteSymbols : 0),
+    m_Feed(p_Config.feedCapacity, p_Config.conflateFeed) {}
+
+template<typename Policy>
+SymbolId MatchingEngine<Policy>::RegisterSymbolImpl(std::string_view p_Symbol) {
+  if (p_Symbol.empty()) return kInvalidSymbol;
+  SymbolId id = m_Symbols.Intern(p_Symbol);
+  while (m_Books.size() < m_Symbols.Size()) {
+    m_Books.push_back(MakeBook<Book>(m_Storage, BookConfig{}));
+    m_Configs.emplace_back();
+  }
+  return id;
+}
+
+template<typename Policy>
+bool MatchingEngine<Policy>::ConfigureBookImpl(const std::string& p_Symbol, const BookConfig& p_Config) {
+  // prices are divided by the scale on the way out
+  if (p_Config.priceScale <= 0) return false;
+  SymbolId id = RegisterSymbolImpl(p_Symbol);
+  if (id == kInvalidSymbol) return false;
+  Book& book = m_Books[id];
+  bool hasOrders = VisitBook(book, [](const auto& p_Book) {
+    return p_Book.BestBid() || p_Book.BestAsk();
+  });
+  if (hasOrders) return false;
+
+  m_Configs[id] = p_Config;
+  book = MakeBook<Book>(m_Storage, p_Config);
+  return true;
+}
+
+template<typename Policy>
+Price MatchingEngine<Policy>::ToPriceImpl(SymbolId p_Symbol, double p_Price) const {
+  std::int64_t scale = p_Symbol < m_Configs.size() ? m_Configs[p_Symbol].priceScale : BookConfig{}.priceScale;
+  return Price::FromDouble(p_Price, scale);
+}
+
+// Book index for p_Order: its symbolId as is, or the interned symbol string
+// for callers that didn't register. kInvalidSymbol for an unknown id or an
+// empty symbol.
+template<typename Policy>
+SymbolId MatchingEngine<Policy>::Resolve(const Order& p_Order) {
+  if (p_Order.symbolId != kInvalidSymbol) {
+    return p_Order.symbolId < m_Books.size() ? p_Order.symbolId : kInvalidSymbol;
+  }
+  return RegisterSymbolImpl(p_Order.symbol);
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::SetCompletionCallbackImpl(CompletionCallback p_Callback) {
+  m_OnComplete = std::move(p_Callback);
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::ProcessImpl(Order&& p_Order) {
+  Match(p_Order);
+  Flush();
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::CancelImpl(SymbolId p_Symbol, OrderId p_Id) {
+  CancelOrder(p_Symbol, p_Id);
+  Flush();
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::ModifyImpl(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice) {
+  ModifyOrder(p_Symbol, p_Id, p_NewVolume, p_NewPrice);
+  Flush();
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::ProcessBatchImpl(std::span<Order> p_Orders) {
+  MatchBatch(p_Orders);
+  // all of the batch's reports go out together
+  Flush();
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::MatchBatch(std::span<Order> p_Orders) {
+  m_BatchOrder.clear();
+  for (std::uint32_t i = 0; i < p_Orders.size(); ++i) {
+    SymbolId id = p_Orders[i].volume > 0 ? Resolve(p_Orders[i]) : kInvalidSymbol;
+    if (id == kInvalidSymbol) {
+      Reject(p_Orders[i]);
+    } else {
+      m_BatchOrder.emplace_back(id, i);
+    }
+  }
+  // group by book, keeping arrival order within each one, so every book is
+  // visited once and stays hot in cache for its whole run
+  std::sort(m_BatchOrder.begin(), m_BatchOrder.end());
+
+  for (std::size_t run = 0; run < m_BatchOrder.size();) {
+    SymbolId id = m_BatchOrder[run].first;
+    std::size_t end = run;
+    while (end < m_BatchOrder.size() && m_BatchOrder[end].first == id) ++end;
+    VisitBook(m_Books[id], [&](auto& p_Book) {
+      for (std::size_t i = run; i < end; ++i) Match(p_Book, id, p_Orders[m_BatchOrder[i].second]);
+    });
+    run = end;
+  }
+}
+
+template<typename Policy>
+std::size_t MatchingEngine<Policy>::DrainReportsImpl(FunctionRef<void(const ExecutionReport&)> p_Consume,
+                                                     std::size_t p_Max) {
+  return m_Reports.Drain(p_Consume, p_Max);
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::Match(const Order& p_Order) {
+  SymbolId id = p_Order.volume > 0 ? Resolve(p_Order) : kInvalidSymbol;
+  if (id == kInvalidSymbol) {
+    Reject(p_Order);
+    return;
+  }
+  VisitBook(m_Books[id], [&](auto& p_Book) { Match(p_Book, id, p_Order); });
+}
+
+template<typename Policy>
+template<typename BookT>
+void MatchingEngine<Policy>::Match(BookT& p_Book, SymbolId p_Symbol, const Order& p_Order, ExecutionReport::Type p_Ack) {
+  if ((p_Order.id != kNoOrderId && m_Orders.Find(p_Order.id)) || // id already resting
+      !p_Book.Fits(p_Order.operation, p_Order.price)) {            // too far off for a flat book
+    Reject(p_Order);
+    return;
+  }
+  m_Reports.Publish(ExecutionReport{0, p_Order.id, p_Order.price, p_Symbol, 0, p_Order.volume, p_Ack});
+
+  RestingOrder incoming{p_Order.id, p_Order.price, p_Order.volume, p_Symbol, m_Clock++, p_Order.operation};
+  // The sweep itself only appends to m_Fills: no index lookups and no
+  // report bookkeeping between two resting orders, so the loop stays small
+  // and its only data-dependent branch is the fill/partial split in the
+  // level. Everything else happens in one pass afterwards.
+  m_Fills.clear();
+  auto result = p_Book.Add(incoming, [this](const RestingOrder& p_Resting, int p_Qty) {
+    m_Fills.push_back(Fill{p_Resting.id, p_Resting.price, p_Qty, p_Resting.volume});
+  });
+  PublishFills(p_Order, p_Symbol);
+  if (result.rested && p_Order.id != kNoOrderId) m_Orders.Insert(p_Order.id, *result.rested);
+  if (m_Feed.Enabled()) {
+    Order::Operation opposite = p_Order.operation == Order::Operation::BUY ? Order::Operation::SELL
+                                                                           : Order::Operation::BUY;
+    for (std::size_t i = 0; i < m_Fills.size(); ++i) {
+      if (i == 0 || m_Fills[i].price != m_Fills[i - 1].price) {
+        m_Touched.push_back(Touch{p_Symbol, opposite, m_Fills[i].price, true});
+      }
+    }
+    if (result.rested) {
+      // the order just rested: the level is new if it's the only one there
+      bool existed = p_Book.LevelAt(p_Order.operation, p_Order.price)->orders > 1;
+      m_Touched.push_back(Touch{p_Symbol, p_Order.operation, p_Order.price, existed});
+    }
+  }
+  BookChanged(p_Book, p_Symbol);
+  if (m_OnComplete) m_OnComplete(p_Order, result.filled);
+}
+
+// Two reports per fill, aggressor then resting side, in fill order.
+template<typename Policy>
+void MatchingEngine<Policy>::PublishFills(const Order& p_Order, SymbolId p_Symbol) {
+  using Type = ExecutionReport::Type;
+  static_assert(static_cast<int>(Type::FILL) == static_cast<int>(Type::PARTIAL_FILL) + 1);
+  // FILL when nothing is left, PARTIAL_FILL otherwise, without a branch
+  auto fillType = [](int p_Leaves) {
+    return static_cast<Type>(static_cast<int>(Type::PARTIAL_FILL) + (p_Leaves == 0));
+  };
+  int leaves = p_Order.volume;
+  for (const Fill& fill : m_Fills) {
+    leaves -= fill.quantity;
+    m_Reports.Publish(ExecutionReport{0, p_Order.id, fill.price, p_Symbol, fill.quantity, leaves,
+                                      fillType(leaves)});
+    m_Reports.Publish(ExecutionReport{0, fill.resting, fill.price, p_Symbol, fill.quantity,
+                                      fill.restingLeaves, fillType(fill.restingLeaves)});
+  }
+  // resting orders that filled completely have left the book
+  for (const Fill& fill : m_Fills) {
+    if (fill.restingLeaves == 0 && fill.resting != kNoOrderId) m_Orders.Erase(fill.resting);
+  }
+}
+
+// Publishes the book's top and, if the last Match traded, the last fill,
+// stamped with the report that brought the book to this state; the full
+// snapshot waits for Flush.
+template<typename Policy>
+template<typename BookT>
+void MatchingEngine<Policy>::BookChanged(const BookT& p_Book, SymbolId p_Symbol) {
+  Price lastPrice;
+  int lastQuantity = 0;
+  if (!m_Fills.empty()) {
+    lastPrice = m_Fills.back().price;
+    lastQuantity = m_Fills.back().quantity;
+  }
+  m_Quotes.Update(p_Symbol, p_Book.TopBid(), p_Book.TopAsk(), lastPrice, lastQuantity, m_Reports.LastSequence());
+  if (m_Snapshots.Covers(p_Symbol) && !m_ChangedFlags[p_Symbol]) {
+    m_ChangedFlags[p_Symbol] = 1;
+    m_Changed.push_back(p_Symbol);
+  }
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::Flush() {
+  m_Reports.Flush();
+  PublishSnapshots();
+  if (m_Feed.Enabled()) PublishLevels();
+}
+
+// O(snapshotLevels) per book changed since the last Flush, whatever number
+// of orders hit it in between.
+template<typename Policy>
+void MatchingEngine<Policy>::PublishSnapshots() {
+  for (SymbolId symbol : m_Changed) {
+    BookSnapshot& snapshot = m_Snapshots.Acquire();
+    snapshot.sequence = m_Reports.LastSequence();
+    VisitBook(m_Books[symbol], [&](const auto& p_Book) {
+      p_Book.Depth(Order::Operation::BUY, m_Snapshots.Levels(),
+                   [&](const LevelSummary& p_Level) { snapshot.bids.push_back(p_Level); });
+      p_Book.Depth(Order::Operation::SELL, m_Snapshots.Levels(),
+                   [&](const LevelSummary& p_Level) { snapshot.asks.push_back(p_Level); });
+    });
+    m_Snapshots.Publish(symbol, snapshot);
+    m_ChangedFlags[symbol] = 0;
+  }
+  m_Changed.clear();
+  m_Snapshots.Reclaim();
+}
+
+// One update per level touched since the last Flush, from its state now:
+// O(levels touched), however many orders went through them.
+template<typename Policy>
+void MatchingEngine<Policy>::PublishLevels() {
+  // each level's first touch first (std::stable_sort would allocate)
+  for (std::size_t i = 0; i < m_Touched.size(); ++i) m_Touched[i].order = static_cast<std::uint32_t>(i);
+  std::sort(m_Touched.begin(), m_Touched.end(), [](const Touch& p_Left, const Touch& p_Right) {
+    if (p_Left.symbol != p_Right.symbol) return p_Left.symbol < p_Right.symbol;
+    if (p_Left.side != p_Right.side) return p_Left.side < p_Right.side;
+    if (p_Left.price != p_Right.price) return p_Left.price < p_Right.price;
+    return p_Left.order < p_Right.order;
+  });
+  using Action = LevelUpdate::Action;
+  for (std::size_t i = 0; i < m_Touched.size(); ++i) {
+    const Touch& touch = m_Touched[i];
+    if (i > 0 && touch.symbol == m_Touched[i - 1].symbol && touch.side == m_Touched[i - 1].side &&
+        touch.price == m_Touched[i - 1].price) {
+      continue;
+    }
+    std::optional<LevelSummary> level = VisitBook(m_Books[touch.symbol], [&](const auto& p_Book) {
+      return p_Book.LevelAt(touch.side, touch.price);
+    });
+    if (!level && !touch.existed) continue; // came and went within the batch
+    LevelUpdate update;
+    update.price = touch.price;
+    update.symbol = touch.symbol;
+    update.side = touch.side;
+    if (level) {
+      update.volume = level->volume;
+      update.orders = level->orders;
+    }
+    update.action = !level ? Action::DELETE : touch.existed ? Action::UPDATE : Action::ADD;
+    m_Feed.Publish(update);
+  }
+  m_Touched.clear();
+  m_Feed.Flush();
+}
+
+template<typename Policy>
+typename MatchingEngine<Policy>::Handle* MatchingEngine<Policy>::FindOrder(SymbolId p_Symbol, OrderId p_Id) {
+  Handle* found = p_Id != kNoOrderId ? m_Orders.Find(p_Id) : nullptr;
+  return found && Level::SymbolOf(m_Storage, *found) == p_Symbol ? found : nullptr;
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::CancelOrder(SymbolId p_Symbol, OrderId p_Id) {
+  Handle* found = FindOrder(p_Symbol, p_Id);
+  if (!found) {
+    Reject(Order{{}, {}, 0, {}, p_Symbol, p_Id});
+    return;
+  }
+  Handle handle = *found;
+  RestingOrder cancelled = Resting(handle);
+  m_Orders.Erase(p_Id);
+  Unlink(handle);
+  m_Reports.Publish(ExecutionReport{0, p_Id, cancelled.price, cancelled.symbol, 0, 0,
+                                    ExecutionReport::Type::CANCELED});
+  if (m_Feed.Enabled()) m_Touched.push_back(Touch{cancelled.symbol, cancelled.side, cancelled.price, true});
+  m_Fills.clear();
+  VisitBook(m_Books[cancelled.symbol], [&](auto& p_Book) { BookChanged(p_Book, cancelled.symbol); });
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::ModifyOrder(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice) {
+  Handle* found = FindOrder(p_Symbol, p_Id);
+  if (!found || p_NewVolume <= 0) {
+    Reject(Order{{}, p_NewPrice, p_NewVolume, {}, p_Symbol, p_Id});
+    return;
+  }
+  Handle handle = *found;
+  RestingOrder resting = Resting(handle);
+  if (p_NewPrice == resting.price && p_NewVolume <= resting.volume) {
+    // pure reduction: only the volume changes, the order keeps its place
+    VisitBook(m_Books[resting.symbol], [&](auto& p_Book) {
+      p_Book.Reduce(handle, p_NewVolume);
+      m_Reports.Publish(ExecutionReport{0, p_Id, resting.price, resting.symbol, 0, p_NewVolume,
+                                        ExecutionReport::Type::REPLACED});
+      m_Fills.clear();
+      BookChanged(p_Book, resting.symbol);
+      if (m_Feed.Enabled()) m_Touched.push_back(Touch{resting.symbol, resting.side, resting.price, true});
+    });
+    return;
+  }
+
+  bool fits = VisitBook(m_Books[resting.symbol], [&](const auto& p_Book) {
+    return p_Book.Fits(resting.side, p_NewPrice);
+  });
+  if (!fits) {
+    // turned away before the order leaves: it keeps resting as it was
+    Reject(Order{{}, p_NewPrice, p_NewVolume, {}, resting.symbol, p_Id});
+    return;
+  }
+
+  RestingOrder old = resting;
+  m_Orders.Erase(p_Id);
+  Unlink(handle);
+  if (m_Feed.Enabled()) m_Touched.push_back(Touch{old.symbol, old.side, old.price, true});
+
+  // re-enter as a fresh order: back of the queue, and it may trade now
+  Order replacement{{}, p_NewPrice, p_NewVolume, old.side, old.symbol, p_Id};
+  VisitBook(m_Books[old.symbol], [&](auto& p_Book) {
+    Match(p_Book, old.symbol, replacement, ExecutionReport::Type::REPLACED);
+  });
+}
+
+template<typename Policy>
+RestingOrder MatchingEngine<Policy>::Resting(const Handle& p_Handle) {
+  return VisitBook(m_Books[Level::SymbolOf(m_Storage, p_Handle)], [&](const auto& p_Book) {
+    return p_Book.At(p_Handle);
+  });
+}
+
+// Take the order at p_Handle out of its book. Ring levels may compact and
+// move other orders while doing so; their index entries follow.
+template<typename Policy>
+void MatchingEngine<Policy>::Unlink(const Handle& p_Handle) {
+  VisitBook(m_Books[Level::SymbolOf(m_Storage, p_Handle)], [&](auto& p_Book) {
+    p_Book.Cancel(p_Handle, [this](OrderId p_Moved, const Handle& p_NewHandle) {
+      if (Handle* entry = m_Orders.Find(p_Moved)) *entry = p_NewHandle;
+    });
+  });
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::Reject(const Order& p_Order) {
+  m_Reports.Publish(ExecutionReport{0, p_Order.id, p_Order.price, p_Order.symbolId, 0, 0,
+                                    ExecutionReport::Type::REJECTED});
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::Apply(Command&& p_Command) {
+  switch (p_Command.type) {
+    case Command::Type::ORDER:
+      Match(p_Command.order);
+      break;
+    case Command::Type::REGISTER:
+      RegisterSymbolImpl(p_Command.order.symbol);
+      break;
+    case Command::Type::CONFIGURE: {
+      bool applied = ConfigureBookImpl(p_Command.order.symbol, p_Command.config);
+      if (p_Command.configured) p_Command.configured->set_value(applied);
+      break;
+    }
+    case Command::Type::CANCEL:
+      CancelOrder(p_Command.order.symbolId, p_Command.order.id);
+      break;
+    case Command::Type::MODIFY:
+      ModifyOrder(p_Command.order.symbolId, p_Command.order.id, p_Command.order.volume, p_Command.order.price);
+      break;
+    case Command::Type::BATCH:
+      MatchBatch(*p_Command.batch);
+      break;
+  }
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::DisplayOrdersImpl() {
+  DisplayOrdersImpl(DisplayQuery{}, [](std::string_view p_Chunk) {
+    std::fwrite(p_Chunk.data(), 1, p_Chunk.size(), stdout);
+  });
+  std::fflush(stdout);
+}
+
+template<typename Policy>
+DisplayPage MatchingEngine<Policy>::DisplayOrdersImpl(const DisplayQuery& p_Query, std::span<char> p_Buffer) {
+  return WriteDepthPage(p_Query, p_Buffer, LiveBooks{*this});
+}
+
+template<typename Policy>
+void MatchingEngine<Policy>::DisplayOrdersImpl(const DisplayQuery& p_Query,
+                                               FunctionRef<void(std::string_view)> p_Sink) {
+  WriteDepth(p_Query, LiveBooks{*this}, p_Sink);
+}
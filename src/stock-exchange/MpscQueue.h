@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "CacheLine.h"
+
+// Bounded multi-producer/single-consumer queue (Vyukov's bounded queue with
+// a single consumer). Each slot carries a sequence number that says whose
+// turn it is: producers claim a position with one CAS on the tail and then
+// publish the slot by bumping its sequence, so producers never wait on each
+// other once they own a slot and there is no lock to convoy on. Slots are
+// preallocated; a push moves into an existing slot.
+template<typename T>
+class MpscQueue {
+public:
+  // p_Capacity is rounded up to a power of two
+  explicit MpscQueue(std::size_t p_Capacity) {
+    std::size_t capacity = 2;
+    while (capacity < p_Capacity) capacity <<= 1;
+    m_Mask = capacity - 1;
+    m_Cells = std::make_unique<Cell[]>(capacity);
+    for (std::size_t i = 0; i < capacity; ++i) {
+      m_Cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  std::size_t Capacity() const { return m_Mask + 1; }
+
+  // Any thread. false if the queue is full.
+  bool TryPush(T&& p_Value) {
+    std::uint64_t position = m_Tail.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &m_Cells[position & m_Mask];
+      std::uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+      std::int64_t diff = static_cast<std::int64_t>(sequence - position);
+      if (diff == 0) {
+        if (m_Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false; // the consumer hasn't freed this slot yet
+      } else {
+        position = m_Tail.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(p_Value);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Calls p_Consume(T&) on up to p_Max published values in
+  // order, stopping at the first slot whose producer hasn't finished yet.
+  template<typename F>
+  std::size_t Drain(F&& p_Consume, std::size_t p_Max = SIZE_MAX) {
+    std::size_t count = 0;
+    while (count < p_Max) {
+      Cell& cell = m_Cells[m_Head & m_Mask];
+      if (cell.sequence.load(std::memory_order_acquire) != m_Head + 1) break;
+      p_Consume(cell.value);
+      cell.sequence.store(m_Head + m_Mask + 1, std::memory_order_release);
+      ++m_Head;
+      ++count;
+    }
+    return count;
+  }
+
+  // Consumer only.
+  bool Empty() const {
+    return m_Cells[m_Head & m_Mask].sequence.load(std::memory_order_acquire) != m_Head + 1;
+  }
+
+private:
+  struct alignas(kCacheLineSize) Cell {
+    std::atomic<std::uint64_t> sequence;
+    T value;
+  };
+
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> m_Tail{0};
+  alignas(kCacheLineSize) std::uint64_t m_Head = 0;
+  std::size_t m_Mask;
+  std::unique_ptr<Cell[]> m_Cells;
+};
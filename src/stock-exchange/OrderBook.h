@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <type_traits>
+
+#include "FlatBookSide.h"
+#include "IStockExchange.h"
+#include "LevelSummary.h"
+#include "Price.h"
+#include "PriceLevel.h"
+#include "RingLevel.h"
+#include "TreeBookSide.h"
+
+// What Add did with an order: how much traded, and where the remainder
+// rests (empty if it filled completely).
+template<typename Handle>
+struct AddResult {
+  int filled;
+  std::optional<Handle> rested;
+};
+
+// Price-time priority limit order book for a single symbol. The level
+// storage of each side is a template parameter (TreeSide or FlatSide), and
+// so is the queue layout inside each level (PriceLevel or RingLevel).
+template<typename BidSide, typename AskSide>
+class BasicOrderBook {
+public:
+  using Handle = typename BidSide::Handle;
+  using Storage = typename BidSide::Storage;
+
+  // Resting orders live in p_Storage (the node pool for PriceLevel). p_Args
+  // are any further side constructor arguments, e.g. the window width for
+  // FlatSide.
+  template<typename... Args>
+    requires std::is_constructible_v<BidSide, Storage&, const Args&...>
+  explicit BasicOrderBook(Storage& p_Storage, const Args&... p_Args)
+    : m_Storage(&p_Storage), m_Bids(p_Storage, p_Args...), m_Asks(p_Storage, p_Args...) {}
+
+  // Match p_Order against the opposite side and rest whatever is left. The
+  // price must Fit its side.
+  // p_OnFill(const RestingOrder&, int qty) is called for every resting
+  // order it trades with (the fill price is that order's price); it's a
+  // template parameter so the call can be inlined into the matching loop.
+  template<typename OnFill>
+  AddResult<Handle> Add(const RestingOrder& p_Order, OnFill&& p_OnFill) {
+    if (p_Order.side == Order::Operation::BUY) {
+      return Match(m_Asks, m_Bids, p_Order, p_OnFill);
+    }
+    return Match(m_Bids, m_Asks, p_Order, p_OnFill);
+  }
+
+  AddResult<Handle> Add(const RestingOrder& p_Order) {
+    return Add(p_Order, [](const RestingOrder&, int) {});
+  }
+
+  // A copy of the resting order at p_Handle. Change its volume through
+  // Reduce, which keeps the level totals in step.
+  RestingOrder At(const Handle& p_Handle) const {
+    return IsBid(p_Handle) ? m_Bids.At(p_Handle) : m_Asks.At(p_Handle);
+  }
+
+  // Remove a resting order given the handle Add returned. If that moves
+  // other orders of the level (RingLevel compaction) p_OnMove(OrderId,
+  // Handle) gets each one's new handle.
+  template<typename OnMove>
+  void Cancel(const Handle& p_Handle, OnMove&& p_OnMove) {
+    if (IsBid(p_Handle)) {
+      m_Bids.Cancel(p_Handle, p_OnMove);
+    } else {
+      m_Asks.Cancel(p_Handle, p_OnMove);
+    }
+  }
+
+  void Cancel(const Handle& p_Handle) {
+    Cancel(p_Handle, [](OrderId, const Handle&) {});
+  }
+
+  // Shrink the order at p_Handle to p_Volume (more than zero, less than it
+  // has) in place, keeping its time priority and the level totals right.
+  void Reduce(const Handle& p_Handle, int p_Volume) {
+    if (IsBid(p_Handle)) {
+      m_Bids.Reduce(p_Handle, p_Volume);
+    } else {
+      m_Asks.Reduce(p_Handle, p_Volume);
+    }
+  }
+
+  // Whether an order on p_Side at p_Price could rest, should any of it be
+  // left: a flat side only takes prices its window can grow to cover.
+  bool Fits(Order::Operation p_Side, Price p_Price) const {
+    return p_Side == Order::Operation::BUY ? m_Bids.Fits(p_Price) : m_Asks.Fits(p_Price);
+  }
+
+  std::optional<Price> BestBid() const { return m_Bids.BestPrice(); }
+  std::optional<Price> BestAsk() const { return m_Asks.BestPrice(); }
+
+  // Best bid and offer with the volume and order count behind them. O(1).
+  std::optional<LevelSummary> TopBid() const { return m_Bids.Top(); }
+  std::optional<LevelSummary> TopAsk() const { return m_Asks.Top(); }
+
+  // One level of one side, if any order rests there.
+  std::optional<LevelSummary> LevelAt(Order::Operation p_Side, Price p_Price) const {
+    return p_Side == Order::Operation::BUY ? m_Bids.LevelAt(p_Price) : m_Asks.LevelAt(p_Price);
+  }
+
+  // p_Fn(const LevelSummary&) for up to p_Levels levels of one side, best
+  // first, or only those worse than p_After. O(p_Levels), independent of
+  // how many orders rest. p_Fn may return false to stop (see VisitLevel).
+  template<typename Fn>
+  void Depth(Order::Operation p_Side, std::size_t p_Levels, Fn&& p_Fn,
+             std::optional<Price> p_After = std::nullopt) const {
+    if (p_Side == Order::Operation::BUY) {
+      m_Bids.Depth(p_Levels, p_Fn, p_After);
+    } else {
+      m_Asks.Depth(p_Levels, p_Fn, p_After);
+    }
+  }
+
+private:
+  bool IsBid(const Handle& p_Handle) const {
+    using Level = typename BidSide::LevelType;
+    return Level::SideOf(*m_Storage, p_Handle) == Order::Operation::BUY;
+  }
+
+  template<typename Opposite, typename Own, typename OnFill>
+  static AddResult<Handle> Match(Opposite& p_Opposite, Own& p_Own, const RestingOrder& p_Order, OnFill& p_OnFill) {
+    int remaining = p_Order.volume;
+    bool sweeping = false;
+    while (remaining > 0 && p_Opposite.Crosses(p_Order.price)) {
+      // past the first level this order is sweeping the book: overlap
+      // loading the level after this one with filling this one
+      if (sweeping) p_Opposite.PrefetchSecond();
+      remaining -= p_Opposite.FillBest(remaining, p_OnFill);
+      sweeping = true;
+    }
+    std::optional<Handle> rested;
+    if (remaining > 0) {
+      RestingOrder rest = p_Order;
+      rest.volume = remaining;
+      rested = p_Own.Rest(rest);
+    }
+    return AddResult<Handle>{p_Order.volume - remaining, rested};
+  }
+
+  Storage* m_Storage; // what a handle needs to say which side it's on
+  BidSide m_Bids;     // highest first
+  AskSide m_Asks; // lowest first
+};
+
+using OrderBook = BasicOrderBook<TreeSide<std::greater<Price>>, TreeSide<std::less<Price>>>;
+using FlatOrderBook = BasicOrderBook<FlatSide<std::greater<Price>>, FlatSide<std::less<Price>>>;
+using RingOrderBook = BasicOrderBook<TreeSide<std::greater<Price>, RingLevel>, TreeSide<std::less<Price>, RingLevel>>;
+using FlatRingOrderBook = BasicOrderBook<FlatSide<std::greater<Price>, RingLevel>, FlatSide<std::less<Price>, RingLevel>>;
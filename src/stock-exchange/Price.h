@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cmath>
+#include <compare>
+#include <cstdint>
+
+// Fixed-point price as a whole number of ticks. The tick size is per
+// instrument: a scale of 100 means one tick is 0.01. Inside the engine prices
+// are only ever compared, subtracted and used as level indices, so they stay
+// integers; converting to and from double happens at the API edge.
+struct Price {
+  std::int64_t ticks = 0;
+
+  constexpr auto operator<=>(const Price&) const = default;
+
+  static Price FromDouble(double p_Value, std::int64_t p_Scale) {
+    return Price{std::llround(p_Value * static_cast<double>(p_Scale))};
+  }
+
+  double ToDouble(std::int64_t p_Scale) const {
+    return static_cast<double>(ticks) / static_cast<double>(p_Scale);
+  }
+};
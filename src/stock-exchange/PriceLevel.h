@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "CacheLine.h"
+#include "IStockExchange.h"
+#include "Price.h"
+#include "RestingOrder.h"
+#include "SlabPool.h"
+#include "SymbolDirectory.h"
+
+class PriceLevel;
+
+// A resting order linked into its level's queue: 32 bytes, two per cache
+// line. What every order of a level shares (price, side, symbol) lives on
+// the level, and the queue links are 32-bit pool indices, which leaves room
+// for the level pointer that lets a node be unlinked without finding its
+// level first.
+struct alignas(32) OrderNode {
+  std::uint32_t prev; // pool indices, SlabPool::kNone at the ends
+  std::uint32_t next;
+  PriceLevel* level;
+  OrderId id;
+  int volume;
+  std::uint32_t timestamp; // as RestingOrder::timestamp
+};
+
+static_assert(sizeof(OrderNode) == 32, "OrderNode must stay two to a cache line");
+
+// Nodes for all books of one matching thread come from one pool.
+using OrderPool = SlabPool<OrderNode>;
+
+// All resting orders at one price, oldest first (time priority), as a
+// doubly linked list of pooled nodes. Appending, filling from the front and
+// unlinking any node are all O(1) and never call malloc. Nodes point back
+// at their level, so a node can be unlinked, and the level's totals kept,
+// without the caller finding the level first; moving a level re-points its
+// nodes.
+//
+// Each level also keeps its total volume and order count, updated on every
+// change, so a depth view never walks a queue.
+//
+// This is one of two queue layouts (see RingLevel.h); both give the sides
+// the same interface: a Handle to find a resting order again, the Storage
+// the book shares, Rest/Fill/FillEach/Reduce/Cancel/At and the totals.
+class PriceLevel {
+public:
+  // the node's pool index: stable until the order leaves the book, and
+  // half the size of a pointer in the engine's id index
+  using Handle = OrderPool::Index;
+  using Storage = OrderPool;
+  // a handle reaches its order without looking up the level
+  static constexpr bool kNodeHandles = true;
+
+  static Price PriceOf(const OrderPool& p_Pool, Handle p_Handle) { return p_Pool[p_Handle].level->m_Price; }
+  static Order::Operation SideOf(const OrderPool& p_Pool, Handle p_Handle) {
+    return p_Pool[p_Handle].level->m_Side;
+  }
+  static SymbolId SymbolOf(const OrderPool& p_Pool, Handle p_Handle) { return p_Pool[p_Handle].level->m_Symbol; }
+
+  PriceLevel() = default;
+  // nodes point at their level: only Take moves one
+  PriceLevel(const PriceLevel&) = delete;
+  PriceLevel& operator=(const PriceLevel&) = delete;
+
+  bool Empty() const { return m_Head == OrderPool::kNone; }
+  std::int64_t Volume() const { return m_Volume; }
+  std::uint32_t Count() const { return m_Count; }
+
+  Handle Rest(OrderPool& p_Pool, const RestingOrder& p_Order) {
+    Handle handle = p_Pool.New();
+    p_Pool[handle] = OrderNode{m_Tail, OrderPool::kNone, this, p_Order.id, p_Order.volume, p_Order.timestamp};
+    if (Empty()) {
+      m_Head = handle;
+    } else {
+      p_Pool[m_Tail].next = handle;
+    }
+    m_Tail = handle;
+    m_Price = p_Order.price;
+    m_Symbol = p_Order.symbol;
+    m_Side = p_Order.side;
+    m_Volume += p_Order.volume;
+    ++m_Count;
+    return handle;
+  }
+
+  // Fill up to p_Volume, oldest order first. Calls
+  // p_OnFill(const RestingOrder&, int qty) for every resting order hit, with
+  // its volume already reduced. Returns the volume that traded.
+  //
+  // Each node's successor is prefetched before the node is filled, so a
+  // sweep through a long queue overlaps its misses instead of stalling on
+  // every link.
+  template<typename OnFill>
+  int Fill(OrderPool& p_Pool, int p_Volume, OnFill&& p_OnFill) {
+    int filled = 0;
+    Handle handle = m_Head;
+    while (filled < p_Volume && handle != OrderPool::kNone) {
+      OrderNode& node = p_Pool[handle];
+      Handle next = node.next;
+      if (next != OrderPool::kNone) PrefetchForWrite(&p_Pool[next]);
+      int qty = std::min(p_Volume - filled, node.volume); // cmov, not a branch
+      node.volume -= qty;
+      filled += qty;
+      p_OnFill(Record(node), qty);
+      if (node.volume == 0) Remove(p_Pool, handle);
+      handle = next;
+    }
+    m_Volume -= filled;
+    return filled;
+  }
+
+  // Replace p_Out with the volumes of the orders, oldest first, and return
+  // their sum.
+  std::int64_t GatherVolumes(const OrderPool& p_Pool, std::vector<int>& p_Out) const {
+    p_Out.clear();
+    std::int64_t total = 0;
+    for (Handle handle = m_Head; handle != OrderPool::kNone; handle = p_Pool[handle].next) {
+      int volume = p_Pool[handle].volume;
+      p_Out.push_back(volume);
+      total += volume;
+    }
+    return total;
+  }
+
+  // Fill the i-th order (oldest first, as GatherVolumes lists them) by
+  // p_Qty[i], which must not exceed its volume. Calls p_OnFill like Fill for
+  // every order with a nonzero quantity. Returns the volume that traded.
+  template<typename OnFill>
+  int FillEach(OrderPool& p_Pool, const int* p_Qty, OnFill&& p_OnFill) {
+    int filled = 0;
+    Handle handle = m_Head;
+    while (handle != OrderPool::kNone) {
+      OrderNode& node = p_Pool[handle];
+      Handle next = node.next;
+      if (next != OrderPool::kNone) PrefetchForWrite(&p_Pool[next]);
+      int qty = *p_Qty++;
+      if (qty != 0) {
+        node.volume -= qty;
+        filled += qty;
+        p_OnFill(Record(node), qty);
+        if (node.volume == 0) Remove(p_Pool, handle);
+      }
+      handle = next;
+    }
+    m_Volume -= filled;
+    return filled;
+  }
+
+  // The oldest order, for prefetching; nullptr if the level is empty.
+  const OrderNode* Front(const OrderPool& p_Pool) const { return Empty() ? nullptr : &p_Pool[m_Head]; }
+
+  // The order at p_Handle as a whole record. Static, like Remove: the node
+  // knows its level.
+  static RestingOrder At(const OrderPool& p_Pool, Handle p_Handle) {
+    const OrderNode& node = p_Pool[p_Handle];
+    return node.level->Record(node);
+  }
+
+  // Nodes never move, so p_OnMove(OrderId, Handle) is never called.
+  template<typename OnMove>
+  void Cancel(OrderPool& p_Pool, Handle p_Handle, OnMove&&) { Remove(p_Pool, p_Handle); }
+
+  // Shrink the order at p_Handle to p_Volume (less than it has now) in
+  // place.
+  static void Reduce(OrderPool& p_Pool, Handle p_Handle, int p_Volume) {
+    OrderNode& node = p_Pool[p_Handle];
+    node.level->m_Volume -= node.volume - p_Volume;
+    node.volume = p_Volume;
+  }
+
+  // Unlink p_Handle from whatever level holds it and give it back to the
+  // pool.
+  static void Remove(OrderPool& p_Pool, Handle p_Handle) {
+    OrderNode& node = p_Pool[p_Handle];
+    PriceLevel* level = node.level;
+    level->m_Volume -= node.volume;
+    --level->m_Count;
+    (node.prev != OrderPool::kNone ? p_Pool[node.prev].next : level->m_Head) = node.next;
+    (node.next != OrderPool::kNone ? p_Pool[node.next].prev : level->m_Tail) = node.prev;
+    p_Pool.Delete(p_Handle);
+  }
+
+  // Steal p_Other's queue: every node has to point at us now. O(orders),
+  // but levels only move when a flat side re-centers.
+  void Take(OrderPool& p_Pool, PriceLevel& p_Other) {
+    m_Head = p_Other.m_Head;
+    m_Tail = p_Other.m_Tail;
+    m_Volume = p_Other.m_Volume;
+    m_Count = p_Other.m_Count;
+    m_Price = p_Other.m_Price;
+    m_Symbol = p_Other.m_Symbol;
+    m_Side = p_Other.m_Side;
+    for (Handle handle = m_Head; handle != OrderPool::kNone; handle = p_Pool[handle].next) {
+      p_Pool[handle].level = this;
+    }
+    p_Other.m_Head = p_Other.m_Tail = OrderPool::kNone;
+    p_Other.m_Volume = 0;
+    p_Other.m_Count = 0;
+  }
+
+private:
+  RestingOrder Record(const OrderNode& p_Node) const {
+    return RestingOrder{p_Node.id, m_Price, p_Node.volume, m_Symbol, p_Node.timestamp, m_Side};
+  }
+
+  // what every order here shares, set by Rest
+  Price m_Price;
+  std::int64_t m_Volume = 0;
+  Handle m_Head = OrderPool::kNone;
+  Handle m_Tail = OrderPool::kNone;
+  std::uint32_t m_Count = 0;
+  SymbolId m_Symbol = kInvalidSymbol;
+  Order::Operation m_Side = Order::Operation::BUY;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "CacheLine.h"
+#include "LevelSummary.h"
+#include "Price.h"
+#include "Seqlock.h"
+#include "SymbolDirectory.h"
+
+// Top of book and last trade of one symbol, as other threads see it. A
+// side with no orders has volume 0 (and a meaningless price); lastQuantity
+// is 0 until the symbol first trades.
+struct Quote {
+  Price bid;
+  Price ask;
+  std::int64_t bidVolume = 0;
+  std::int64_t askVolume = 0;
+  Price lastPrice;
+  // the last execution report the quote reflects
+  std::uint64_t sequence = 0;
+  int lastQuantity = 0;
+
+  bool operator==(const Quote&) const = default;
+};
+
+// Every symbol's Quote in a seqlock of its own: one cache line each, so
+// readers of different symbols never share a line, and a reader takes
+// exactly one miss when the quote it polls has changed. Fixed capacity,
+// allocated up front, so slots never move under a reader.
+class QuoteBoard {
+public:
+  explicit QuoteBoard(std::size_t p_Symbols)
+    : m_Slots(std::make_unique<Seqlock<Quote>[]>(p_Symbols)), m_Size(p_Symbols) {}
+
+  // Matcher only. Publishes p_Symbol's top of book, stamped with
+  // p_Sequence, if it changed. p_LastQuantity 0 means no trade since the
+  // previous update, so the last trade stays as it was. Symbols past the
+  // capacity aren't published.
+  void Update(SymbolId p_Symbol, const std::optional<LevelSummary>& p_Bid, const std::optional<LevelSummary>& p_Ask,
+              Price p_LastPrice, int p_LastQuantity, std::uint64_t p_Sequence) {
+    if (p_Symbol >= m_Size) return;
+    Seqlock<Quote>& slot = m_Slots[p_Symbol];
+    Quote current = slot.Peek();
+    Quote next = current;
+    next.bid = p_Bid ? p_Bid->price : Price{};
+    next.bidVolume = p_Bid ? p_Bid->volume : 0;
+    next.ask = p_Ask ? p_Ask->price : Price{};
+    next.askVolume = p_Ask ? p_Ask->volume : 0;
+    if (p_LastQuantity != 0) {
+      next.lastPrice = p_LastPrice;
+      next.lastQuantity = p_LastQuantity;
+    }
+    // a trade at the same price and size as the previous one is still news
+    if (next == current && p_LastQuantity == 0) return;
+    next.sequence = p_Sequence;
+    slot.Store(next);
+  }
+
+  // Any thread, no lock. Empty for symbols past the capacity.
+  std::optional<Quote> Read(SymbolId p_Symbol) const {
+    if (p_Symbol >= m_Size) return std::nullopt;
+    return m_Slots[p_Symbol].Load();
+  }
+
+private:
+  std::unique_ptr<Seqlock<Quote>[]> m_Slots;
+  std::size_t m_Size;
+};
+
+static_assert(sizeof(Seqlock<Quote>) == kCacheLineSize);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ExecutionReport.h"
+#include "IStockExchange.h"
+#include "Price.h"
+#include "SymbolDirectory.h"
+
+// The engine's own record of an order, built from the public Order once at
+// the edge. Unlike Order (std::string, padding) it's 32 bytes and aligned
+// to 32, so in a RingLevel queue, which stores records back to back, two
+// share a cache line and a sweep touches half as many lines. The default
+// PriceLevel queue keeps the same 32 bytes per order in another shape: its
+// OrderNode leaves price, side and symbol to the level and spends the room
+// on queue links (see PriceLevel.h).
+struct alignas(32) RestingOrder {
+  OrderId id;
+  Price price;
+  int volume;
+  SymbolId symbol;
+  // arrival sequence within the engine: logical time priority, 32 bits so
+  // the record stays compact (wraps after 4G orders)
+  std::uint32_t timestamp;
+  Order::Operation side;
+};
+
+static_assert(sizeof(RestingOrder) == 32, "RestingOrder must stay 32 bytes");
+static_assert(alignof(RestingOrder) == 32, "RestingOrder must not straddle cache lines");
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "IStockExchange.h"
+#include "Price.h"
+#include "RestingOrder.h"
+#include "SymbolDirectory.h"
+
+// Where a RingLevel order sits: its level (price) and its position in that
+// level's queue. Positions are absolute sequence numbers (wrapping, compared
+// modulo 2^32), so growing the ring doesn't move anyone; only compaction
+// does, and it reports every move. Packed to 16 bytes: it's the value type
+// of the engine's id index, and that index is the hottest random-access
+// structure on the cancel path.
+struct QueueSlot {
+  Price price;
+  std::uint32_t seq;
+  std::uint32_t symbol : 31;
+  std::uint32_t buy : 1;
+};
+
+static_assert(sizeof(QueueSlot) == 16);
+
+// Nothing shared between ring levels: each one owns its buffer.
+struct RingStorage {};
+
+// All resting orders at one price, oldest first, stored by value in a
+// power-of-two ring. Matching walks the records in order, 32 bytes each,
+// which the hardware prefetcher follows; there's no pointer to chase.
+//
+// A cancel in the middle can't close the gap, so it leaves a tombstone
+// (volume 0) that fills skip and pop. Once tombstones make up more than
+// half of the queue it's compacted: live orders slide to the front, keeping
+// their order, and p_OnMove(OrderId, QueueSlot) tells the owner of each new
+// position. Same interface as PriceLevel otherwise, totals included.
+class RingLevel {
+public:
+  using Handle = QueueSlot;
+  using Storage = RingStorage;
+  static constexpr bool kNodeHandles = false;
+
+  // a slot says it all, the storage is only there for the interface
+  static Price PriceOf(const RingStorage&, const Handle& p_Handle) { return p_Handle.price; }
+  static Order::Operation SideOf(const RingStorage&, const Handle& p_Handle) {
+    return p_Handle.buy ? Order::Operation::BUY : Order::Operation::SELL;
+  }
+  static SymbolId SymbolOf(const RingStorage&, const Handle& p_Handle) { return p_Handle.symbol; }
+
+  bool Empty() const { return m_Live == 0; }
+  std::int64_t Volume() const { return m_Volume; }
+  std::uint32_t Count() const { return m_Live; }
+
+  Handle Rest(RingStorage&, const RestingOrder& p_Order) {
+    if (m_Tail - m_Head == Capacity()) Grow();
+    std::uint32_t seq = m_Tail++;
+    m_Entries[seq & m_Mask] = p_Order;
+    ++m_Live;
+    m_Volume += p_Order.volume;
+    return MakeHandle(p_Order, seq);
+  }
+
+  // Fill up to p_Volume, oldest order first. Calls
+  // p_OnFill(const RestingOrder&, int qty) for every resting order hit, with
+  // its volume already reduced. Returns the volume that traded.
+  template<typename OnFill>
+  int Fill(RingStorage&, int p_Volume, OnFill&& p_OnFill) {
+    int filled = 0;
+    while (filled < p_Volume && m_Live > 0) {
+      RestingOrder& resting = m_Entries[m_Head & m_Mask];
+      if (resting.volume == 0) { // tombstone
+        ++m_Head;
+        --m_Tombstones;
+        continue;
+      }
+      int qty = std::min(p_Volume - filled, resting.volume);
+      resting.volume -= qty;
+      filled += qty;
+      p_OnFill(static_cast<const RestingOrder&>(resting), qty);
+      if (resting.volume == 0) {
+        ++m_Head;
+        --m_Live;
+      }
+    }
+    m_Volume -= filled;
+    if (m_Live == 0) Reset();
+    return filled;
+  }
+
+  // Replace p_Out with the volumes of the live orders, oldest first, and
+  // return their sum. Tombstones are written too but the cursor doesn't move
+  // past them, so the copy has no branch.
+  std::int64_t GatherVolumes(const RingStorage&, std::vector<int>& p_Out) const {
+    p_Out.resize(m_Tail - m_Head);
+    int* out = p_Out.data();
+    std::int64_t total = 0;
+    for (std::uint32_t seq = m_Head; seq != m_Tail; ++seq) {
+      int volume = m_Entries[seq & m_Mask].volume;
+      *out = volume;
+      out += volume != 0;
+      total += volume;
+    }
+    p_Out.resize(static_cast<std::size_t>(out - p_Out.data()));
+    return total;
+  }
+
+  // Fill the i-th live order (oldest first, as GatherVolumes lists them) by
+  // p_Qty[i], which must not exceed its volume. Calls p_OnFill like Fill for
+  // every order with a nonzero quantity. Orders emptied in the middle become
+  // tombstones; the next cancel compacts them if there are enough.
+  template<typename OnFill>
+  int FillEach(RingStorage&, const int* p_Qty, OnFill&& p_OnFill) {
+    int filled = 0;
+    for (std::uint32_t seq = m_Head; seq != m_Tail; ++seq) {
+      RestingOrder& resting = m_Entries[seq & m_Mask];
+      if (resting.volume == 0) continue; // tombstone
+      int qty = *p_Qty++;
+      if (qty == 0) continue;
+      resting.volume -= qty;
+      filled += qty;
+      p_OnFill(static_cast<const RestingOrder&>(resting), qty);
+      if (resting.volume == 0) {
+        --m_Live;
+        ++m_Tombstones;
+      }
+    }
+    m_Volume -= filled;
+    if (m_Live == 0) {
+      Reset();
+    } else {
+      PopTombstones();
+    }
+    return filled;
+  }
+
+  // The oldest slot (maybe a tombstone), for prefetching; nullptr if the
+  // level is empty. Within a level the walk is sequential and the hardware
+  // prefetcher keeps up on its own.
+  const RestingOrder* Front(const RingStorage&) const { return Empty() ? nullptr : &m_Entries[m_Head & m_Mask]; }
+
+  RestingOrder At(const RingStorage&, const Handle& p_Handle) const { return m_Entries[p_Handle.seq & m_Mask]; }
+
+  // Shrink the order at p_Handle to p_Volume (less than it has now, but not
+  // zero: that's a cancel) in place.
+  void Reduce(RingStorage&, const Handle& p_Handle, int p_Volume) {
+    RestingOrder& entry = Entry(p_Handle);
+    m_Volume -= entry.volume - p_Volume;
+    entry.volume = p_Volume;
+  }
+
+  template<typename OnMove>
+  void Cancel(RingStorage&, const Handle& p_Handle, OnMove&& p_OnMove) {
+    RestingOrder& entry = Entry(p_Handle);
+    m_Volume -= entry.volume;
+    entry.volume = 0;
+    --m_Live;
+    ++m_Tombstones;
+    if (m_Live == 0) {
+      Reset();
+    } else if (p_Handle.seq == m_Head) {
+      PopTombstones();
+    } else if (m_Tombstones > m_Live && m_Tombstones >= kMinCompaction) {
+      Compact(p_OnMove);
+    }
+  }
+
+  // Steal p_Other's queue; handles don't name the level, so nothing else
+  // changes.
+  void Take(RingStorage&, RingLevel& p_Other) { *this = std::move(p_Other); }
+
+private:
+  static constexpr std::uint32_t kInitialCapacity = 8;
+  // don't bother compacting a handful of tombstones, fills pop them anyway
+  static constexpr std::uint32_t kMinCompaction = 16;
+
+  std::uint32_t Capacity() const { return m_Entries ? m_Mask + 1 : 0; }
+
+  RestingOrder& Entry(const Handle& p_Handle) { return m_Entries[p_Handle.seq & m_Mask]; }
+
+  static Handle MakeHandle(const RestingOrder& p_Order, std::uint32_t p_Seq) {
+    return Handle{p_Order.price, p_Seq, p_Order.symbol, p_Order.side == Order::Operation::BUY};
+  }
+
+  void Reset() {
+    m_Head = m_Tail;
+    m_Tombstones = 0;
+  }
+
+  void PopTombstones() {
+    while (m_Head != m_Tail && m_Entries[m_Head & m_Mask].volume == 0) {
+      ++m_Head;
+      --m_Tombstones;
+    }
+  }
+
+  // Double the ring. Every entry goes to seq & new mask, so handles stay
+  // valid. The new buffer is left uninitialized, only [head, tail) is read.
+  void Grow() {
+    std::uint32_t capacity = m_Entries ? 2 * Capacity() : kInitialCapacity;
+    std::unique_ptr<RestingOrder[]> entries(new RestingOrder[capacity]);
+    std::uint32_t mask = capacity - 1;
+    for (std::uint32_t seq = m_Head; seq != m_Tail; ++seq) {
+      entries[seq & mask] = m_Entries[seq & m_Mask];
+    }
+    m_Entries = std::move(entries);
+    m_Mask = mask;
+  }
+
+  template<typename OnMove>
+  void Compact(OnMove& p_OnMove) {
+    PopTombstones();
+    std::uint32_t write = m_Head;
+    for (std::uint32_t read = m_Head; read != m_Tail; ++read) {
+      const RestingOrder& entry = m_Entries[read & m_Mask];
+      if (entry.volume == 0) continue;
+      if (read != write) {
+        m_Entries[write & m_Mask] = entry;
+        p_OnMove(entry.id, MakeHandle(entry, write));
+      }
+      ++write;
+    }
+    m_Tail = write;
+    m_Tombstones = 0;
+  }
+
+  std::unique_ptr<RestingOrder[]> m_Entries;
+  std::uint32_t m_Mask = 0;
+  // [m_Head, m_Tail) are in use, live orders and tombstones
+  std::uint32_t m_Head = 0;
+  std::uint32_t m_Tail = 0;
+  std::uint32_t m_Live = 0;
+  std::uint32_t m_Tombstones = 0;
+  std::int64_t m_Volume = 0; // of the live orders
+};
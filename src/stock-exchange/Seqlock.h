@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "CacheLine.h"
+
+// Single-writer sequence lock around a small trivially copyable T, starting
+// on its own cache line. The writer never waits; readers never write, so
+// any number of them can poll without bouncing the line between cores (it
+// only moves when the value changes), and they retry if a write overlapped
+// their read.
+//
+// The payload is held as relaxed atomic words rather than a plain T, which
+// keeps the racy reads well defined; the fences order them against the
+// version.
+template<typename T>
+class alignas(kCacheLineSize) Seqlock {
+  static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>);
+  static_assert(sizeof(T) % sizeof(std::uint64_t) == 0);
+
+public:
+  // Writer only.
+  void Store(const T& p_Value) {
+    std::uint64_t words[kWords];
+    std::memcpy(words, &p_Value, sizeof(T));
+    std::uint64_t version = m_Version.load(std::memory_order_relaxed);
+    m_Version.store(version + 1, std::memory_order_relaxed); // odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < kWords; ++i) m_Words[i].store(words[i], std::memory_order_relaxed);
+    m_Version.store(version + 2, std::memory_order_release);
+  }
+
+  // Writer only: the current value, without the retry loop (nobody else
+  // writes it).
+  T Peek() const {
+    std::uint64_t words[kWords];
+    for (std::size_t i = 0; i < kWords; ++i) words[i] = m_Words[i].load(std::memory_order_relaxed);
+    return FromWords(words);
+  }
+
+  // Any thread. A consistent copy of the last Store.
+  T Load() const {
+    std::uint64_t words[kWords];
+    for (;;) {
+      std::uint64_t before = m_Version.load(std::memory_order_acquire);
+      if (before & 1) {
+        CpuRelax();
+        continue;
+      }
+      for (std::size_t i = 0; i < kWords; ++i) words[i] = m_Words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (m_Version.load(std::memory_order_relaxed) == before) break;
+    }
+    return FromWords(words);
+  }
+
+private:
+  static constexpr std::size_t kWords = sizeof(T) / sizeof(std::uint64_t);
+
+  static T FromWords(const std::uint64_t* p_Words) {
+    T value;
+    std::memcpy(static_cast<void*>(&value), p_Words, sizeof(T));
+    return value;
+  }
+
+  std::atomic<std::uint64_t> m_Version{0};
+  std::atomic<std::uint64_t> m_Words[kWords] = {};
+};
@@ -0,0 +1,278 @@
+#include "ShardedStockExchange.h"
+
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+void PinToCore(std::size_t p_Core) {
+#ifdef __linux__
+  std::size_t cores = std::thread::hardware_concurrency();
+  if (cores == 0) return;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(p_Core % cores, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)p_Core;
+#endif
+}
+
+} // namespace
+
+template<typename Inbox, typename Engine>
+ShardedStockExchange<Inbox, Engine>::ShardedStockExchange(const EngineConfig& p_Config) {
+  m_Shards.reserve(p_Config.shards);
+  for (std::size_t i = 0; i < p_Config.shards; ++i) {
+    m_Shards.push_back(std::make_unique<Shard>(p_Config));
+  }
+  for (std::size_t i = 0; i < p_Config.shards; ++i) {
+    Shard& shard = *m_Shards[i];
+    shard.thread = std::thread([this, &shard, core = p_Config.firstCore + i, pin = p_Config.pinThreads]() {
+      Run(shard, core, pin);
+    });
+  }
+}
+
+template<typename Inbox, typename Engine>
+ShardedStockExchange<Inbox, Engine>::~ShardedStockExchange() {
+  for (auto& shard : m_Shards) {
+    shard->stopping = true;
+    shard->inbox.Wake();
+  }
+  for (auto& shard : m_Shards) shard->thread.join();
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::Test(TestCallback p_Callback) {
+  std::cout << "ShardedStockExchange::Test START\n";
+  p_Callback();
+  return;
+}
+
+template<typename Inbox, typename Engine>
+SymbolId ShardedStockExchange<Inbox, Engine>::RegisterSymbol(std::string_view p_Symbol) {
+  if (p_Symbol.empty()) return kInvalidSymbol;
+  {
+    std::shared_lock<std::shared_mutex> lock(m_SymbolsMutex);
+    SymbolId id = m_Symbols.Find(p_Symbol);
+    if (id != kInvalidSymbol) return id;
+  }
+  std::unique_lock<std::shared_mutex> lock(m_SymbolsMutex);
+  std::size_t known = m_Symbols.Size();
+  SymbolId id = m_Symbols.Intern(p_Symbol);
+  if (m_Symbols.Size() == known) return id; // raced with another registration
+
+  m_PriceScales.push_back(BookConfig{}.priceScale);
+  // still under the lock, so every shard sees registrations in the same order
+  for (auto& shard : m_Shards) {
+    shard->inbox.Post(Command{Command::Type::REGISTER, Order{std::string(p_Symbol), {}, 0, {}}, {}});
+  }
+  return id;
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::ConfigureBook(const std::string& p_Symbol, const BookConfig& p_Config) {
+  if (p_Config.priceScale <= 0) return;
+  SymbolId id = RegisterSymbol(p_Symbol);
+  if (id == kInvalidSymbol) return;
+  // Only the shard knows whether the book has resting orders (and so keeps
+  // its config); the front's scale follows its answer.
+  std::promise<bool> configured;
+  std::future<bool> applied = configured.get_future();
+  ShardOf(id).inbox.Post(Command{Command::Type::CONFIGURE, Order{p_Symbol, {}, 0, {}}, p_Config, &configured});
+  if (!applied.get()) return;
+  std::unique_lock<std::shared_mutex> lock(m_SymbolsMutex);
+  m_PriceScales[id] = p_Config.priceScale;
+}
+
+template<typename Inbox, typename Engine>
+Price ShardedStockExchange<Inbox, Engine>::ToPrice(SymbolId p_Symbol, double p_Price) const {
+  std::shared_lock<std::shared_mutex> lock(m_SymbolsMutex);
+  std::int64_t scale = p_Symbol < m_PriceScales.size() ? m_PriceScales[p_Symbol] : BookConfig{}.priceScale;
+  return Price::FromDouble(p_Price, scale);
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::SetCompletionCallback(CompletionCallback p_Callback) {
+  // each shard gets its own copy, so shards never share callback state
+  for (auto& shard : m_Shards) shard->exchange.SetCompletionCallback(p_Callback);
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::Process(Order&& p_Order) {
+  if (p_Order.symbolId == kInvalidSymbol) {
+    // slow path: resolve the name here so shards only ever see ids (an
+    // empty one stays invalid, and the shard rejects the order)
+    p_Order.symbolId = RegisterSymbol(p_Order.symbol);
+    p_Order.symbol.clear();
+  }
+  ShardOf(p_Order.symbolId).inbox.Post(Command{Command::Type::ORDER, std::move(p_Order), {}});
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::Cancel(SymbolId p_Symbol, OrderId p_Id) {
+  // the symbol's shard holds the order, or answers REJECTED if it doesn't
+  ShardOf(p_Symbol).inbox.Post(Command{Command::Type::CANCEL, Order{{}, {}, 0, {}, p_Symbol, p_Id}, {}});
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::Modify(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice) {
+  ShardOf(p_Symbol).inbox.Post(Command{Command::Type::MODIFY, Order{{}, p_NewPrice, p_NewVolume, {}, p_Symbol, p_Id}, {}});
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::ProcessBatch(std::span<Order> p_Orders) {
+  // Bucket the burst by shard and hand each shard its part as one command:
+  // one queue push and one publish per shard rather than per order. The
+  // shard regroups its part by symbol and reports it as one batch; arrival
+  // order within a symbol is kept. Buckets are buffers the shards handed
+  // back, so a steady flow of batches doesn't allocate; the table of them
+  // is per caller thread and empty between calls.
+  thread_local std::vector<std::unique_ptr<std::vector<Order>>> buckets;
+  buckets.resize(m_Shards.size());
+  for (Order& order : p_Orders) {
+    if (order.symbolId == kInvalidSymbol) {
+      order.symbolId = RegisterSymbol(order.symbol);
+      order.symbol.clear();
+    }
+    std::size_t shard = ShardIndex(order.symbolId);
+    auto& bucket = buckets[shard];
+    if (!bucket) {
+      bucket = TakeSpare(*m_Shards[shard]);
+      bucket->reserve(p_Orders.size() / m_Shards.size() + 1);
+    }
+    bucket->push_back(std::move(order));
+  }
+  for (std::size_t i = 0; i < buckets.size(); ++i) {
+    if (!buckets[i]) continue;
+    m_Shards[i]->inbox.Post(Command{Command::Type::BATCH, {}, {}, nullptr, std::move(buckets[i])});
+  }
+}
+
+template<typename Inbox, typename Engine>
+std::unique_ptr<std::vector<Order>> ShardedStockExchange<Inbox, Engine>::TakeSpare(Shard& p_Shard) {
+  std::unique_ptr<std::vector<Order>> spare;
+  {
+    std::lock_guard<std::mutex> lock(p_Shard.sparesMutex);
+    p_Shard.spares.Drain([&](std::unique_ptr<std::vector<Order>>& p_Spare) { spare = std::move(p_Spare); }, 1);
+  }
+  return spare ? std::move(spare) : std::make_unique<std::vector<Order>>();
+}
+
+template<typename Inbox, typename Engine>
+std::size_t ShardedStockExchange<Inbox, Engine>::DrainReports(FunctionRef<void(const ExecutionReport&)> p_Consume,
+                                                      std::size_t p_Max) {
+  // shard by shard; reports are ordered within a shard (and so per symbol)
+  std::size_t count = 0;
+  for (auto& shard : m_Shards) {
+    if (count == p_Max) break;
+    count += shard->exchange.DrainReports(p_Consume, p_Max - count);
+  }
+  return count;
+}
+
+template<typename Inbox, typename Engine>
+std::uint64_t ShardedStockExchange<Inbox, Engine>::DroppedReports() const {
+  std::uint64_t dropped = 0;
+  for (const auto& shard : m_Shards) dropped += shard->exchange.DroppedReports();
+  return dropped;
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::DisplayOrders() {
+  DisplayOrders(DisplayQuery{}, [](std::string_view p_Chunk) {
+    std::fwrite(p_Chunk.data(), 1, p_Chunk.size(), stdout);
+  });
+  std::fflush(stdout);
+}
+
+template<typename Inbox, typename Engine>
+DisplayPage ShardedStockExchange<Inbox, Engine>::DisplayOrders(const DisplayQuery& p_Query, std::span<char> p_Buffer) {
+  return WriteDepthPage(p_Query, p_Buffer, SnapshotBooks{*this, std::shared_lock(m_SymbolsMutex)});
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::DisplayOrders(const DisplayQuery& p_Query,
+                                                        FunctionRef<void(std::string_view)> p_Sink) {
+  WriteDepth(p_Query, SnapshotBooks{*this, std::shared_lock(m_SymbolsMutex)}, p_Sink);
+}
+
+template<typename Inbox, typename Engine>
+std::optional<Quote> ShardedStockExchange<Inbox, Engine>::ReadQuote(SymbolId p_Symbol) const {
+  // the owning shard publishes it; its board is fixed before the threads start
+  return ShardOf(p_Symbol).exchange.ReadQuote(p_Symbol);
+}
+
+template<typename Inbox, typename Engine>
+bool ShardedStockExchange<Inbox, Engine>::ReadSnapshot(SymbolId p_Symbol,
+                                                       FunctionRef<void(const BookSnapshot&)> p_Read) const {
+  return ShardOf(p_Symbol).exchange.ReadSnapshot(p_Symbol, p_Read);
+}
+
+template<typename Inbox, typename Engine>
+std::size_t ShardedStockExchange<Inbox, Engine>::DrainMarketData(FunctionRef<void(const LevelUpdate&)> p_Consume,
+                                                                 std::size_t p_Max) {
+  // like DrainReports: a symbol's updates all come from its shard
+  std::size_t count = 0;
+  for (auto& shard : m_Shards) {
+    if (count == p_Max) break;
+    count += shard->exchange.DrainMarketData(p_Consume, p_Max - count);
+  }
+  return count;
+}
+
+template<typename Inbox, typename Engine>
+void ShardedStockExchange<Inbox, Engine>::Run(Shard& p_Shard, std::size_t p_Core, bool p_Pin) {
+  if (p_Pin) PinToCore(p_Core);
+
+  for (;;) {
+    // read the flag before draining so nothing posted ahead of it is lost
+    bool stopping = p_Shard.stopping.load(std::memory_order_acquire);
+    std::size_t count = p_Shard.inbox.Drain([&](Command& p_Command) {
+      p_Shard.exchange.Apply(std::move(p_Command));
+      if (p_Command.batch) {
+        // give the buffer back now, not whenever a caller reuses the queue
+        // slot: emptied, to the callers if they have room for it
+        p_Command.batch->clear();
+        p_Shard.spares.TryPush(std::move(p_Command.batch));
+        p_Command.batch.reset();
+      }
+    });
+    // once per batch: reports, snapshots and level updates of the books it
+    // changed
+    p_Shard.exchange.Flush();
+    if (count == 0) {
+      if (stopping) return;
+      p_Shard.inbox.Idle(p_Shard.stopping);
+    }
+  }
+}
+
+template<typename Inbox, typename Engine>
+std::size_t ShardedStockExchange<Inbox, Engine>::ShardIndex(SymbolId p_Symbol) const {
+  // Fibonacci hashing spreads consecutive ids across shards
+  std::uint64_t hash = static_cast<std::uint64_t>(p_Symbol) * 0x9E3779B97F4A7C15ull;
+  return (hash >> 32) % m_Shards.size();
+}
+
+// every ingest mode for every instrument class IStockExchange::Create offers
+template class ShardedStockExchange<LockedInbox, MatchingEngineFor<InstrumentClass::MIXED>>;
+template class ShardedStockExchange<LockedInbox, MatchingEngineFor<InstrumentClass::EQUITY>>;
+template class ShardedStockExchange<LockedInbox, MatchingEngineFor<InstrumentClass::WIDE_RANGE>>;
+template class ShardedStockExchange<LockedInbox, MatchingEngineFor<InstrumentClass::PRO_RATA>>;
+template class ShardedStockExchange<SpscInbox, MatchingEngineFor<InstrumentClass::MIXED>>;
+template class ShardedStockExchange<SpscInbox, MatchingEngineFor<InstrumentClass::EQUITY>>;
+template class ShardedStockExchange<SpscInbox, MatchingEngineFor<InstrumentClass::WIDE_RANGE>>;
+template class ShardedStockExchange<SpscInbox, MatchingEngineFor<InstrumentClass::PRO_RATA>>;
+template class ShardedStockExchange<MpscInbox, MatchingEngineFor<InstrumentClass::MIXED>>;
+template class ShardedStockExchange<MpscInbox, MatchingEngineFor<InstrumentClass::EQUITY>>;
+template class ShardedStockExchange<MpscInbox, MatchingEngineFor<InstrumentClass::WIDE_RANGE>>;
+template class ShardedStockExchange<MpscInbox, MatchingEngineFor<InstrumentClass::PRO_RATA>>;
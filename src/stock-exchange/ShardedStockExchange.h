@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "BookSnapshot.h"
+#include "Command.h"
+#include "IStockExchange.h"
+#include "Inbox.h"
+#include "LevelWriter.h"
+#include "MatchingEngine.h"
+#include "SpscRing.h"
+#include "SymbolDirectory.h"
+
+// Thread-per-core engine: every symbol is hashed to one of N shards, and each
+// shard is a plain Engine (a MatchingEngine instantiation) driven by its own
+// (optionally pinned) thread.
+// A shard's books are only ever touched by that thread, so matching takes no
+// locks. Callers hand work over through the shard's Inbox (see Inbox.h) and
+// return without waiting for it to be matched. With one shard this is simply
+// a dedicated matcher thread behind a queue.
+template<typename Inbox, typename Engine = MatchingEngine<MixedPolicy>>
+class ShardedStockExchange : public IStockExchange {
+public:
+  explicit ShardedStockExchange(const EngineConfig& p_Config);
+  virtual ~ShardedStockExchange() override;
+  virtual void Test(TestCallback p_Callback) override;
+  virtual SymbolId RegisterSymbol(std::string_view p_Symbol) override;
+  virtual void ConfigureBook(const std::string& p_Symbol, const BookConfig& p_Config) override;
+  virtual Price ToPrice(SymbolId p_Symbol, double p_Price) const override;
+  virtual void SetCompletionCallback(CompletionCallback p_Callback) override;
+  virtual void Process(Order&& p_Order) override;
+  virtual void Cancel(SymbolId p_Symbol, OrderId p_Id) override;
+  virtual void Modify(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice) override;
+  virtual void ProcessBatch(std::span<Order> p_Orders) override;
+  virtual std::size_t DrainReports(FunctionRef<void(const ExecutionReport&)> p_Consume,
+                                   std::size_t p_Max = SIZE_MAX) override;
+  virtual std::uint64_t DroppedReports() const override;
+  virtual void DisplayOrders() override;
+  virtual DisplayPage DisplayOrders(const DisplayQuery& p_Query, std::span<char> p_Buffer) override;
+  virtual void DisplayOrders(const DisplayQuery& p_Query, FunctionRef<void(std::string_view)> p_Sink) override;
+  virtual std::optional<Quote> ReadQuote(SymbolId p_Symbol) const override;
+  virtual bool ReadSnapshot(SymbolId p_Symbol, FunctionRef<void(const BookSnapshot&)> p_Read) const override;
+  virtual std::size_t DrainMarketData(FunctionRef<void(const LevelUpdate&)> p_Consume,
+                                      std::size_t p_Max = SIZE_MAX) override;
+
+private:
+  // batch buffers a shard keeps for reuse; any more are freed
+  static constexpr std::size_t kSpareBatches = 16;
+
+  struct Shard {
+    explicit Shard(const EngineConfig& p_Config)
+      : exchange(p_Config), inbox(p_Config.queueCapacity), spares(kSpareBatches) {}
+
+    Engine exchange;
+    Inbox inbox;
+    // BATCH buffers on their way back from the matcher, emptied, for the
+    // callers' next ProcessBatch. Callers take them under the mutex, since
+    // there may be several; the matcher never does.
+    SpscRing<std::unique_ptr<std::vector<Order>>> spares;
+    std::mutex sparesMutex;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+  };
+
+  // the books as WriteDepthPage walks them: names and scales from the
+  // front, levels from the shards' latest snapshots
+  struct SnapshotBooks {
+    const ShardedStockExchange& exchange;
+    std::shared_lock<std::shared_mutex> lock;
+
+    SymbolId Size() const { return static_cast<SymbolId>(exchange.m_Symbols.Size()); }
+    SymbolId Find(std::string_view p_Symbol) const { return exchange.m_Symbols.Find(p_Symbol); }
+    std::string_view Name(SymbolId p_Symbol) const { return exchange.m_Symbols.Name(p_Symbol); }
+    std::int64_t PriceScale(SymbolId p_Symbol) const { return exchange.m_PriceScales[p_Symbol]; }
+
+    template<typename Fn>
+    void Depth(SymbolId p_Symbol, Order::Operation p_Side, std::size_t p_Max, Fn&& p_Fn,
+               std::optional<Price> p_After) const {
+      exchange.ReadSnapshot(p_Symbol, [&](const BookSnapshot& p_Snapshot) {
+        p_Snapshot.Depth(p_Side, p_Max, p_Fn, p_After);
+      });
+    }
+  };
+
+  void Run(Shard& p_Shard, std::size_t p_Core, bool p_Pin);
+  static std::unique_ptr<std::vector<Order>> TakeSpare(Shard& p_Shard);
+  std::size_t ShardIndex(SymbolId p_Symbol) const;
+  Shard& ShardOf(SymbolId p_Symbol) const { return *m_Shards[ShardIndex(p_Symbol)]; }
+
+  // Front-end copies of the symbol table, shared by all caller threads.
+  // Registrations are sent to every shard so all of them agree on SymbolIds.
+  mutable std::shared_mutex m_SymbolsMutex;
+  SymbolDirectory m_Symbols;
+  std::vector<std::int64_t> m_PriceScales;
+
+  std::vector<std::unique_ptr<Shard>> m_Shards;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// Fixed-size object pool carved out of large slabs. Objects are named by a
+// 32-bit index rather than a pointer (up to 4G of them; New throws
+// std::length_error past that), so structures that link pooled objects
+// store half as much per link. Freed objects go on an
+// intrusive free list (the link lives in the dead object's own storage) and are
+// handed out again LIFO, so a churning workload keeps reusing the same warm
+// memory instead of going back to malloc. Slabs are only returned when the
+// pool is destroyed. Not thread-safe: one pool per matching thread.
+template<typename T>
+class SlabPool {
+public:
+  using Index = std::uint32_t;
+  static constexpr Index kNone = ~Index{0};
+
+  // 2MB, one huge page
+  static constexpr std::size_t kSlabBytes = std::size_t{2} << 20;
+
+  // p_HugePages asks for huge-page backed slabs (Linux only): explicit
+  // hugetlb pages if the system has them reserved, otherwise transparent
+  // huge pages via madvise. Cuts TLB misses when the pool gets large.
+  explicit SlabPool(bool p_HugePages = false) : m_HugePages(p_HugePages) {}
+
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+
+  ~SlabPool() {
+    for (const Slab& slab : m_Slabs) Release(slab);
+  }
+
+  template<typename... Args>
+  Index New(Args&&... p_Args) {
+    if (m_FreeList == kNone) Grow();
+    Index index = m_FreeList;
+    Slot& slot = SlotAt(index);
+    m_FreeList = slot.next;
+    ++m_InUse;
+    ::new (static_cast<void*>(slot.storage)) T(std::forward<Args>(p_Args)...);
+    return index;
+  }
+
+  void Delete(Index p_Index) {
+    (*this)[p_Index].~T();
+    SlotAt(p_Index).next = m_FreeList;
+    m_FreeList = p_Index;
+    --m_InUse;
+  }
+
+  // One load from the slab table, then the object: the table is a few
+  // words per 2MB and stays in cache.
+  T& operator[](Index p_Index) { return *std::launder(reinterpret_cast<T*>(SlotAt(p_Index).storage)); }
+  const T& operator[](Index p_Index) const {
+    return *std::launder(reinterpret_cast<const T*>(SlotAt(p_Index).storage));
+  }
+
+  std::size_t InUse() const { return m_InUse; }
+  std::size_t Capacity() const { return m_Slabs.size() * kSlotsPerSlab; }
+  std::size_t Bytes() const { return m_Slabs.size() * kSlabBytes; }
+
+private:
+  union Slot {
+    Index next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  static constexpr std::size_t kSlotsPerSlab = kSlabBytes / sizeof(Slot);
+
+  struct Slab {
+    Slot* slots;
+    bool mapped;
+  };
+
+  Slot& SlotAt(Index p_Index) const { return m_Slabs[p_Index / kSlotsPerSlab].slots[p_Index % kSlotsPerSlab]; }
+
+  void Grow() {
+    // kNone is never a slot: past that, indices would wrap onto live objects
+    if ((m_Slabs.size() + 1) * kSlotsPerSlab > kNone) throw std::length_error("SlabPool: out of 32-bit indices");
+    Slab slab = Acquire();
+    auto first = static_cast<Index>(m_Slabs.size() * kSlotsPerSlab);
+    m_Slabs.push_back(slab);
+    // thread the new slots onto the free list in address order
+    for (std::size_t i = kSlotsPerSlab; i-- > 0;) {
+      slab.slots[i].next = m_FreeList;
+      m_FreeList = first + static_cast<Index>(i);
+    }
+  }
+
+  Slab Acquire() {
+#ifdef __linux__
+    if (m_HugePages) {
+      void* memory = mmap(nullptr, kSlabBytes, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (memory == MAP_FAILED) {
+        memory = mmap(nullptr, kSlabBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory != MAP_FAILED) madvise(memory, kSlabBytes, MADV_HUGEPAGE);
+      }
+      if (memory != MAP_FAILED) return Slab{static_cast<Slot*>(memory), true};
+    }
+#endif
+    return Slab{static_cast<Slot*>(::operator new(kSlabBytes, std::align_val_t{alignof(Slot)})), false};
+  }
+
+  static void Release(const Slab& p_Slab) {
+#ifdef __linux__
+    if (p_Slab.mapped) {
+      munmap(p_Slab.slots, kSlabBytes);
+      return;
+    }
+#endif
+    ::operator delete(p_Slab.slots, std::align_val_t{alignof(Slot)});
+  }
+
+  bool m_HugePages;
+  Index m_FreeList = kNone;
+  std::size_t m_InUse = 0;
+  std::vector<Slab> m_Slabs;
+};
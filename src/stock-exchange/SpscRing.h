@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "CacheLine.h"
+
+// Bounded single-producer/single-consumer ring in the style of the LMAX
+// Disruptor. Slots are allocated once up front and reused, so a push is a
+// move into an existing slot and never allocates. The producer and consumer
+// sequences sit on their own cache lines, and each side keeps a private copy
+// of the other's sequence so it only touches the shared line when it looks
+// full (producer) or empty (consumer).
+template<typename T>
+class SpscRing {
+public:
+  // p_Capacity is rounded up to a power of two
+  explicit SpscRing(std::size_t p_Capacity) {
+    std::size_t capacity = 1;
+    while (capacity < p_Capacity) capacity <<= 1;
+    m_Mask = capacity - 1;
+    // not value-initialized: slots are written before they're read, and
+    // pages of a big ring of plain records stay untouched until used
+    m_Slots = std::make_unique_for_overwrite<T[]>(capacity);
+  }
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  std::size_t Capacity() const { return m_Mask + 1; }
+
+  // Producer only. false if the ring is full.
+  bool TryPush(T&& p_Value) {
+    std::uint64_t tail = m_Producer.tail.load(std::memory_order_relaxed);
+    if (tail - m_Producer.cachedHead > m_Mask) {
+      m_Producer.cachedHead = m_Consumer.head.load(std::memory_order_acquire);
+      if (tail - m_Producer.cachedHead > m_Mask) return false;
+    }
+    m_Slots[tail & m_Mask] = std::move(p_Value);
+    m_Producer.tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Producer only. How many values a push could take right now; the
+  // consumer can only make it more.
+  std::size_t Space() {
+    std::uint64_t tail = m_Producer.tail.load(std::memory_order_relaxed);
+    m_Producer.cachedHead = m_Consumer.head.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(Capacity() - (tail - m_Producer.cachedHead));
+  }
+
+  // Producer only. Copies as many of p_Values as fit and publishes them
+  // with one store. Returns how many were pushed.
+  std::size_t TryPushSome(const T* p_Values, std::size_t p_Count) {
+    std::uint64_t tail = m_Producer.tail.load(std::memory_order_relaxed);
+    std::uint64_t space = Capacity() - (tail - m_Producer.cachedHead);
+    if (space < p_Count) {
+      m_Producer.cachedHead = m_Consumer.head.load(std::memory_order_acquire);
+      space = Capacity() - (tail - m_Producer.cachedHead);
+    }
+    std::size_t count = space < p_Count ? static_cast<std::size_t>(space) : p_Count;
+    for (std::size_t i = 0; i < count; ++i) m_Slots[(tail + i) & m_Mask] = p_Values[i];
+    m_Producer.tail.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  // Consumer only. Calls p_Consume(T&) on up to p_Max queued values, oldest
+  // first, and releases their slots in one store. Returns how many it saw.
+  template<typename F>
+  std::size_t Drain(F&& p_Consume, std::size_t p_Max = SIZE_MAX) {
+    std::uint64_t head = m_Consumer.head.load(std::memory_order_relaxed);
+    if (head == m_Consumer.cachedTail) {
+      m_Consumer.cachedTail = m_Producer.tail.load(std::memory_order_acquire);
+      if (head == m_Consumer.cachedTail) return 0;
+    }
+    std::uint64_t available = m_Consumer.cachedTail - head;
+    std::size_t count = available < p_Max ? static_cast<std::size_t>(available) : p_Max;
+    for (std::size_t i = 0; i < count; ++i) p_Consume(m_Slots[(head + i) & m_Mask]);
+    m_Consumer.head.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  // Either side; only a hint while the other side is running.
+  bool Empty() const {
+    return m_Consumer.head.load(std::memory_order_acquire) ==
+           m_Producer.tail.load(std::memory_order_acquire);
+  }
+
+private:
+  struct alignas(kCacheLineSize) ProducerSide {
+    std::atomic<std::uint64_t> tail{0};
+    std::uint64_t cachedHead = 0;
+  };
+
+  struct alignas(kCacheLineSize) ConsumerSide {
+    std::atomic<std::uint64_t> head{0};
+    std::uint64_t cachedTail = 0;
+  };
+
+  ProducerSide m_Producer;
+  ConsumerSide m_Consumer;
+  std::size_t m_Mask;
+  std::unique_ptr<T[]> m_Slots;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "BookSnapshot.h"
+#include "Callback.h"
+#include "ExecutionReport.h"
+#include "IStockExchange.h"
+#include "MarketData.h"
+#include "Price.h"
+#include "Quote.h"
+#include "SymbolDirectory.h"
+
+// The IStockExchange operations as a static (CRTP) interface, for embedders
+// that link the engine into their own process. Code written against
+// StaticExchange<E> calls E's implementation directly: no vtable, no
+// unique_ptr, and with the definitions visible (MatchingEngine.h) the whole
+// Process can be inlined into the caller's decode loop.
+//
+// Derived provides the ...Impl functions (they may be private, with
+// StaticExchange<Derived> as a friend). IStockExchange stays the ABI-stable
+// way in; BasicStockExchange implements it on top of the same engine.
+template<typename Derived>
+class StaticExchange {
+public:
+  SymbolId RegisterSymbol(std::string_view p_Symbol) { return Self().RegisterSymbolImpl(p_Symbol); }
+
+  void ConfigureBook(const std::string& p_Symbol, const BookConfig& p_Config) {
+    Self().ConfigureBookImpl(p_Symbol, p_Config);
+  }
+
+  Price ToPrice(SymbolId p_Symbol, double p_Price) const { return Self().ToPriceImpl(p_Symbol, p_Price); }
+
+  void SetCompletionCallback(CompletionCallback p_Callback) {
+    Self().SetCompletionCallbackImpl(std::move(p_Callback));
+  }
+
+  void Process(Order&& p_Order) { Self().ProcessImpl(std::move(p_Order)); }
+  void Cancel(SymbolId p_Symbol, OrderId p_Id) { Self().CancelImpl(p_Symbol, p_Id); }
+  void Modify(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice) {
+    Self().ModifyImpl(p_Symbol, p_Id, p_NewVolume, p_NewPrice);
+  }
+  void ProcessBatch(std::span<Order> p_Orders) { Self().ProcessBatchImpl(p_Orders); }
+
+  std::size_t DrainReports(FunctionRef<void(const ExecutionReport&)> p_Consume, std::size_t p_Max = SIZE_MAX) {
+    return Self().DrainReportsImpl(p_Consume, p_Max);
+  }
+  std::uint64_t DroppedReports() const { return Self().DroppedReportsImpl(); }
+
+  void DisplayOrders() { Self().DisplayOrdersImpl(); }
+  DisplayPage DisplayOrders(const DisplayQuery& p_Query, std::span<char> p_Buffer) {
+    return Self().DisplayOrdersImpl(p_Query, p_Buffer);
+  }
+  void DisplayOrders(const DisplayQuery& p_Query, FunctionRef<void(std::string_view)> p_Sink) {
+    Self().DisplayOrdersImpl(p_Query, p_Sink);
+  }
+  std::optional<Quote> ReadQuote(SymbolId p_Symbol) const { return Self().ReadQuoteImpl(p_Symbol); }
+  bool ReadSnapshot(SymbolId p_Symbol, FunctionRef<void(const BookSnapshot&)> p_Read) const {
+    return Self().ReadSnapshotImpl(p_Symbol, p_Read);
+  }
+  std::size_t DrainMarketData(FunctionRef<void(const LevelUpdate&)> p_Consume, std::size_t p_Max = SIZE_MAX) {
+    return Self().DrainMarketDataImpl(p_Consume, p_Max);
+  }
+
+protected:
+  // only as a base
+  StaticExchange() = default;
+  ~StaticExchange() = default;
+
+private:
+  Derived& Self() { return static_cast<Derived&>(*this); }
+  const Derived& Self() const { return static_cast<const Derived&>(*this); }
+};
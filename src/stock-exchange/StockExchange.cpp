@@ -1,23 +1,111 @@
 #include "StockExchange.h"
 
 #include <iostream>
+#include <utility>
 
-StockExchange::StockExchange() {}
+template<typename Policy>
+BasicStockExchange<Policy>::BasicStockExchange(const EngineConfig& p_Config) : m_Engine(p_Config) {}
 
-StockExchange::~StockExchange() {}
+template<typename Policy>
+BasicStockExchange<Policy>::~BasicStockExchange() {}
 
-void StockExchange::Test(TestCallback p_Callback) {
-  std::cout << "StockExchange::Test START" << std::endl;
+template<typename Policy>
+void BasicStockExchange<Policy>::Test(TestCallback p_Callback) {
+  std::cout << "StockExchange::Test START\n";
   p_Callback();
   return;
 }
 
-void StockExchange::Process(Order&& p_Order) {
-  // do something that could take a while
-  // callback when done to fire event
+template<typename Policy>
+SymbolId BasicStockExchange<Policy>::RegisterSymbol(std::string_view p_Symbol) {
+  return m_Engine.RegisterSymbol(p_Symbol);
+}
+
+template<typename Policy>
+void BasicStockExchange<Policy>::ConfigureBook(const std::string& p_Symbol, const BookConfig& p_Config) {
+  m_Engine.ConfigureBook(p_Symbol, p_Config);
+}
+
+template<typename Policy>
+Price BasicStockExchange<Policy>::ToPrice(SymbolId p_Symbol, double p_Price) const {
+  return m_Engine.ToPrice(p_Symbol, p_Price);
+}
+
+template<typename Policy>
+void BasicStockExchange<Policy>::SetCompletionCallback(CompletionCallback p_Callback) {
+  m_Engine.SetCompletionCallback(std::move(p_Callback));
+}
+
+template<typename Policy>
+void BasicStockExchange<Policy>::Process(Order&& p_Order) {
+  m_Engine.Process(std::move(p_Order));
+}
+
+template<typename Policy>
+void BasicStockExchange<Policy>::Cancel(SymbolId p_Symbol, OrderId p_Id) {
+  m_Engine.Cancel(p_Symbol, p_Id);
+}
+
+template<typename Policy>
+void BasicStockExchange<Policy>::Modify(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice) {
+  m_Engine.Modify(p_Symbol, p_Id, p_NewVolume, p_NewPrice);
+}
+
+template<typename Policy>
+void BasicStockExchange<Policy>::ProcessBatch(std::span<Order> p_Orders) {
+  m_Engine.ProcessBatch(p_Orders);
+}
+
+template<typename Policy>
+std::size_t BasicStockExchange<Policy>::DrainReports(FunctionRef<void(const ExecutionReport&)> p_Consume,
+                                                     std::size_t p_Max) {
+  return m_Engine.DrainReports(p_Consume, p_Max);
+}
+
+template<typename Policy>
+std::uint64_t BasicStockExchange<Policy>::DroppedReports() const {
+  return m_Engine.DroppedReports();
+}
+
+template<typename Policy>
+void BasicStockExchange<Policy>::DisplayOrders() {
+  m_Engine.DisplayOrders();
+}
 
+template<typename Policy>
+DisplayPage BasicStockExchange<Policy>::DisplayOrders(const DisplayQuery& p_Query, std::span<char> p_Buffer) {
+  return m_Engine.DisplayOrders(p_Query, p_Buffer);
 }
 
-void StockExchange::DisplayOrders() {
+template<typename Policy>
+void BasicStockExchange<Policy>::DisplayOrders(const DisplayQuery& p_Query,
+                                               FunctionRef<void(std::string_view)> p_Sink) {
+  m_Engine.DisplayOrders(p_Query, p_Sink);
+}
+
+template<typename Policy>
+std::optional<Quote> BasicStockExchange<Policy>::ReadQuote(SymbolId p_Symbol) const {
+  return m_Engine.ReadQuote(p_Symbol);
+}
 
+template<typename Policy>
+bool BasicStockExchange<Policy>::ReadSnapshot(SymbolId p_Symbol,
+                                              FunctionRef<void(const BookSnapshot&)> p_Read) const {
+  return m_Engine.ReadSnapshot(p_Symbol, p_Read);
 }
+
+template<typename Policy>
+std::size_t BasicStockExchange<Policy>::DrainMarketData(FunctionRef<void(const LevelUpdate&)> p_Consume,
+                                                        std::size_t p_Max) {
+  return m_Engine.DrainMarketData(p_Consume, p_Max);
+}
+
+template class MatchingEngine<PolicyFor<InstrumentClass::MIXED>::type>;
+template class MatchingEngine<PolicyFor<InstrumentClass::EQUITY>::type>;
+template class MatchingEngine<PolicyFor<InstrumentClass::WIDE_RANGE>::type>;
+template class MatchingEngine<PolicyFor<InstrumentClass::PRO_RATA>::type>;
+
+template class BasicStockExchange<PolicyFor<InstrumentClass::MIXED>::type>;
+template class BasicStockExchange<PolicyFor<InstrumentClass::EQUITY>::type>;
+template class BasicStockExchange<PolicyFor<InstrumentClass::WIDE_RANGE>::type>;
+template class BasicStockExchange<PolicyFor<InstrumentClass::PRO_RATA>::type>;
@@ -1,15 +1,52 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "BookPolicy.h"
+#include "Callback.h"
 #include "IStockExchange.h"
+#include "MatchingEngine.h"
+#include "SymbolDirectory.h"
 
-class StockExchange : public IStockExchange {
+// IStockExchange on top of a MatchingEngine: the ABI-stable, virtual way in
+// that IStockExchange::Create hands out. StockExchange is the MIXED one;
+// Create picks the instantiation from EngineConfig::instruments.
+template<typename Policy>
+class BasicStockExchange final : public IStockExchange {
 public:
-  StockExchange();
-  virtual ~StockExchange() override;
+  explicit BasicStockExchange(const EngineConfig& p_Config = {});
+  virtual ~BasicStockExchange() override;
   virtual void Test(TestCallback p_Callback) override;
+  virtual SymbolId RegisterSymbol(std::string_view p_Symbol) override;
+  virtual void ConfigureBook(const std::string& p_Symbol, const BookConfig& p_Config) override;
+  virtual Price ToPrice(SymbolId p_Symbol, double p_Price) const override;
+  virtual void SetCompletionCallback(CompletionCallback p_Callback) override;
   virtual void Process(Order&& p_Order) override;
+  virtual void Cancel(SymbolId p_Symbol, OrderId p_Id) override;
+  virtual void Modify(SymbolId p_Symbol, OrderId p_Id, int p_NewVolume, Price p_NewPrice) override;
+  virtual void ProcessBatch(std::span<Order> p_Orders) override;
+  virtual std::size_t DrainReports(FunctionRef<void(const ExecutionReport&)> p_Consume,
+                                   std::size_t p_Max = SIZE_MAX) override;
+  virtual std::uint64_t DroppedReports() const override;
   virtual void DisplayOrders() override;
+  virtual DisplayPage DisplayOrders(const DisplayQuery& p_Query, std::span<char> p_Buffer) override;
+  virtual void DisplayOrders(const DisplayQuery& p_Query, FunctionRef<void(std::string_view)> p_Sink) override;
+  virtual std::optional<Quote> ReadQuote(SymbolId p_Symbol) const override;
+  virtual bool ReadSnapshot(SymbolId p_Symbol, FunctionRef<void(const BookSnapshot&)> p_Read) const override;
+  virtual std::size_t DrainMarketData(FunctionRef<void(const LevelUpdate&)> p_Consume,
+                                      std::size_t p_Max = SIZE_MAX) override;
 
 private:
-  // data
+  MatchingEngine<Policy> m_Engine;
 };
+
+using StockExchange = BasicStockExchange<MixedPolicy>;
+
+// the engine IStockExchange::Create builds for an instrument class
+template<InstrumentClass Class>
+using StockExchangeFor = BasicStockExchange<typename PolicyFor<Class>::type>;
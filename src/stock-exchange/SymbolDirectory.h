@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Dense per-exchange symbol number, 0..N-1 in registration order, so books
+// can live in a plain array indexed by it.
+using SymbolId = std::uint32_t;
+
+constexpr SymbolId kInvalidSymbol = static_cast<SymbolId>(-1);
+
+// Interns each ticker once. String hashing only happens here, at the API
+// edge; everything behind it works with SymbolId.
+class SymbolDirectory {
+public:
+  // Returns the existing id for p_Name or assigns the next one.
+  SymbolId Intern(std::string_view p_Name) {
+    auto it = m_Ids.find(p_Name);
+    if (it != m_Ids.end()) return it->second;
+    SymbolId id = static_cast<SymbolId>(m_Names.size());
+    m_Names.emplace_back(p_Name);
+    m_Ids.emplace(m_Names.back(), id);
+    return id;
+  }
+
+  // kInvalidSymbol if p_Name was never interned
+  SymbolId Find(std::string_view p_Name) const {
+    auto it = m_Ids.find(p_Name);
+    return it == m_Ids.end() ? kInvalidSymbol : it->second;
+  }
+
+  bool Contains(SymbolId p_Id) const { return p_Id < m_Names.size(); }
+  const std::string& Name(SymbolId p_Id) const { return m_Names[p_Id]; }
+  std::size_t Size() const { return m_Names.size(); }
+
+private:
+  // lets m_Ids be searched with a string_view without building a std::string
+  struct Hash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view p_Name) const {
+      return std::hash<std::string_view>{}(p_Name);
+    }
+  };
+
+  std::vector<std::string> m_Names;
+  std::unordered_map<std::string, SymbolId, Hash, std::equal_to<>> m_Ids;
+};
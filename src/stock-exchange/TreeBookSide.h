@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <optional>
+
+#include "CacheLine.h"
+#include "LevelSummary.h"
+#include "Matching.h"
+#include "Price.h"
+#include "PriceLevel.h"
+
+// One side of a book as a balanced tree of levels. Levels are kept sorted
+// best-first by Compare, so the best price is always m_Levels.begin() - O(1)
+// to look up. Works for any price range, but every hop is a pointer chase.
+//
+// Every level in the tree has orders: one that empties is erased right away,
+// wherever it is. Each level keeps its own iterator for that, and a node
+// handle reaches its level, so a cancel erases without a tree search
+// (std::map::erase(iterator) is amortized O(1)).
+//
+// Level is the queue layout of each price level, PriceLevel or RingLevel,
+// and Matching the rule that shares a fill out within a level.
+template<typename Compare, typename Level = PriceLevel, typename Matching = FifoMatching>
+class TreeSide {
+public:
+  using LevelType = Level;
+  using Handle = typename Level::Handle;
+  using Storage = typename Level::Storage;
+
+  explicit TreeSide(Storage& p_Storage) : m_Storage(&p_Storage) {}
+
+  bool Empty() const { return m_Levels.empty(); }
+
+  std::optional<Price> BestPrice() const {
+    if (m_Levels.empty()) return std::nullopt;
+    return m_Levels.begin()->first;
+  }
+
+  // The best level with its totals. O(1).
+  std::optional<LevelSummary> Top() const {
+    if (m_Levels.empty()) return std::nullopt;
+    return Summary(*m_Levels.begin());
+  }
+
+  // p_Fn(const LevelSummary&) for up to p_Max levels, best first, or only
+  // those worse than p_After if given; see VisitLevel for stopping early.
+  template<typename Fn>
+  void Depth(std::size_t p_Max, Fn&& p_Fn, std::optional<Price> p_After = std::nullopt) const {
+    auto it = p_After ? m_Levels.upper_bound(*p_After) : m_Levels.begin();
+    for (; it != m_Levels.end() && p_Max > 0; ++it, --p_Max) {
+      if (!VisitLevel(p_Fn, Summary(*it))) return;
+    }
+  }
+
+  // The level at p_Price, if any order rests there. O(log n).
+  std::optional<LevelSummary> LevelAt(Price p_Price) const {
+    auto it = m_Levels.find(p_Price);
+    if (it == m_Levels.end()) return std::nullopt;
+    return Summary(*it);
+  }
+
+  // true if an incoming order on the other side at p_Price can trade
+  // against our best level
+  bool Crosses(Price p_Price) const {
+    return !m_Levels.empty() && !Compare{}(p_Price, m_Levels.begin()->first);
+  }
+
+  // any price can rest in a tree
+  bool Fits(Price) const { return true; }
+
+  Handle Rest(const RestingOrder& p_Order) {
+    auto [it, added] = m_Levels.try_emplace(p_Order.price);
+    if (added) it->second.self = it;
+    return it->second.Rest(*m_Storage, p_Order);
+  }
+
+  RestingOrder At(const Handle& p_Handle) const {
+    if constexpr (Level::kNodeHandles) {
+      return Level::At(*m_Storage, p_Handle);
+    } else {
+      return m_Levels.find(Level::PriceOf(*m_Storage, p_Handle))->second.At(*m_Storage, p_Handle);
+    }
+  }
+
+  // Shrink the order at p_Handle to p_Volume in place; it keeps its place.
+  void Reduce(const Handle& p_Handle, int p_Volume) {
+    if constexpr (Level::kNodeHandles) {
+      Level::Reduce(*m_Storage, p_Handle, p_Volume);
+    } else {
+      m_Levels.find(Level::PriceOf(*m_Storage, p_Handle))->second.Reduce(*m_Storage, p_Handle, p_Volume);
+    }
+  }
+
+  // Remove the order at p_Handle from this side, and its level with it if
+  // that was the last order. O(1) for node handles (the node knows its
+  // level), O(log n) otherwise.
+  template<typename OnMove>
+  void Cancel(const Handle& p_Handle, OnMove&& p_OnMove) {
+    TreeLevel* level;
+    if constexpr (Level::kNodeHandles) {
+      level = static_cast<TreeLevel*>((*m_Storage)[p_Handle].level);
+      Level::Remove(*m_Storage, p_Handle);
+    } else {
+      level = &m_Levels.find(Level::PriceOf(*m_Storage, p_Handle))->second;
+      level->Cancel(*m_Storage, p_Handle, p_OnMove);
+    }
+    if (level->Empty()) m_Levels.erase(level->self);
+  }
+
+  // Fill up to p_Volume against the best level, calling
+  // p_OnFill(const RestingOrder&, int qty) per resting order hit.
+  // Returns the volume that traded.
+  template<typename OnFill>
+  int FillBest(int p_Volume, OnFill&& p_OnFill) {
+    auto levelIt = m_Levels.begin();
+    int filled = Matching::Fill(static_cast<Level&>(levelIt->second), *m_Storage, p_Volume, p_OnFill);
+    if (levelIt->second.Empty()) m_Levels.erase(levelIt);
+    return filled;
+  }
+
+  // Start loading the first order of the level after the best one, so a
+  // sweep that runs through the best level finds the next one in cache.
+  void PrefetchSecond() const {
+    if (m_Levels.size() < 2) return;
+    if (auto* front = std::next(m_Levels.begin())->second.Front(*m_Storage)) PrefetchForWrite(front);
+  }
+
+private:
+  // a level that knows where it sits in m_Levels; PriceLevel nodes point
+  // at the Level inside it
+  struct TreeLevel;
+  using Levels = std::map<Price, TreeLevel, Compare>;
+  struct TreeLevel : Level {
+    typename Levels::iterator self;
+  };
+
+  template<typename Entry>
+  static LevelSummary Summary(const Entry& p_Entry) {
+    return LevelSummary{p_Entry.first, p_Entry.second.Volume(), p_Entry.second.Count()};
+  }
+
+  Storage* m_Storage;
+  Levels m_Levels;
+};
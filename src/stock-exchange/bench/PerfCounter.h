@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Counts hardware cache misses of the calling thread between Start() and
+// Stop(). Valid() is false where perf events are unavailable (non-Linux,
+// containers, perf_event_paranoid too high), in which case Stop() returns 0.
+class PerfCounter {
+public:
+  PerfCounter() {
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    m_Fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+
+  ~PerfCounter() {
+#ifdef __linux__
+    if (m_Fd >= 0) close(m_Fd);
+#endif
+  }
+
+  PerfCounter(const PerfCounter&) = delete;
+  PerfCounter& operator=(const PerfCounter&) = delete;
+
+  bool Valid() const { return m_Fd >= 0; }
+
+  void Start() {
+#ifdef __linux__
+    if (!Valid()) return;
+    ioctl(m_Fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(m_Fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  std::uint64_t Stop() {
+    std::uint64_t count = 0;
+#ifdef __linux__
+    if (!Valid()) return 0;
+    ioctl(m_Fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(m_Fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+    return count;
+  }
+
+private:
+  int m_Fd = -1;
+};
@@ -0,0 +1,46 @@
+// Worst case for best-price discovery: a sparse ask side (one order every
+// kGap ticks) swept by a single large buy, so almost every step of the
+// sweep has to skip a run of empty levels.
+//
+// build: g++ -O2 -std=c++20 -I.. book-sweep.cpp -o book-sweep
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "OrderBook.h"
+
+namespace {
+
+constexpr int kRounds = 200;
+constexpr int kGap = 64; // ticks between resting orders
+
+template<typename Book>
+void Run(const char* p_Name, Book& p_Book, long p_Levels) {
+  int restingPerRound = static_cast<int>(p_Levels / kGap);
+  double total = 0;
+  for (int round = 0; round < kRounds; ++round) {
+    for (int i = 0; i < restingPerRound; ++i) {
+      p_Book.Add(RestingOrder{0, Price{10'000 + i * kGap}, 1, 0, 0, Order::Operation::SELL});
+    }
+    RestingOrder sweep{0, Price{10'000 + p_Levels}, restingPerRound, 0, 0, Order::Operation::BUY};
+    auto start = std::chrono::steady_clock::now();
+    int filled = p_Book.Add(sweep).filled;
+    total += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (filled != restingPerRound) std::printf("short sweep: %d\n", filled);
+  }
+  std::printf("%-6s %8.1f ns/level crossed, %d levels per sweep\n", p_Name,
+              total / kRounds / restingPerRound, restingPerRound);
+}
+
+} // namespace
+
+int main() {
+  constexpr long kLevels = 64 * 1024;
+  OrderPool pool;
+  OrderBook tree(pool);
+  FlatOrderBook flat(pool, static_cast<std::size_t>(2 * kLevels));
+  Run("tree", tree, kLevels);
+  Run("flat", flat, kLevels);
+  return 0;
+}
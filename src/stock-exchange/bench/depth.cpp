@@ -0,0 +1,52 @@
+// Cost of a 10-level depth view against books of growing size. Levels keep
+// their totals, so the view should cost the same whatever the number of
+// resting orders behind those levels.
+//
+// build: g++ -O2 -std=c++20 -I.. depth.cpp -o depth
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "BookPolicy.h"
+
+namespace {
+
+constexpr int kViews = 100'000;
+constexpr std::size_t kDepth = 10;
+constexpr int kLevels = 200; // per side
+
+template<typename Book>
+void Run(const char* p_Name, int p_Orders) {
+  OrderPool pool;
+  Book book = MakeBook<Book>(pool, BookConfig{});
+  std::mt19937 rng(2);
+  for (int i = 0; i < p_Orders; ++i) {
+    bool buy = i & 1;
+    std::int64_t offset = 1 + static_cast<std::int64_t>(rng() % kLevels);
+    book.Add(RestingOrder{static_cast<OrderId>(i + 1), Price{buy ? 10'000 - offset : 10'000 + offset},
+                          1 + static_cast<int>(rng() % 100), 0, 0, buy ? Order::Operation::BUY : Order::Operation::SELL});
+  }
+
+  std::int64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int view = 0; view < kViews; ++view) {
+    for (Order::Operation side : {Order::Operation::BUY, Order::Operation::SELL}) {
+      book.Depth(side, kDepth, [&](const LevelSummary& p_Level) { checksum += p_Level.volume + p_Level.orders; });
+    }
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kViews;
+  std::printf("%-5s %8d orders: %7.1f ns per %zu-level view of both sides  (%lld)\n", p_Name, p_Orders, ns,
+              kDepth, static_cast<long long>(checksum));
+}
+
+} // namespace
+
+int main() {
+  for (int orders : {1'000, 100'000, 1'000'000}) {
+    Run<OrderBook>("tree", orders);
+    Run<FlatOrderBook>("flat", orders);
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+// Per-order cost of the two ways into the same engine: virtual calls through
+// the IStockExchange that Create hands out, and static calls through
+// StaticExchange on a MatchingEngine whose definitions the loop sees. Both
+// run the same decode loop over the same order flow on an EQUITY (flat)
+// engine; best of kRounds.
+//
+// build: g++ -O2 -std=c++20 -pthread -I.. dispatch.cpp ../StockExchange.cpp ../ShardedStockExchange.cpp ../IStockExchange.cpp -o dispatch
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "IStockExchange.h"
+#include "MatchingEngine.h"
+
+namespace {
+
+constexpr int kOrders = 2'000'000;
+constexpr int kRounds = 5;
+
+// a wire message, as a gateway would hand it over
+struct Message {
+  std::int64_t ticks;
+  std::int32_t volume;
+  std::uint8_t buy;
+  OrderId id;
+};
+
+// passive and marketable orders a few ticks around a fixed mid, with a
+// cancel now and then
+std::vector<Message> MakeFlow() {
+  std::mt19937 rng(3);
+  std::vector<Message> messages;
+  messages.reserve(kOrders);
+  for (OrderId id = 1; messages.size() < kOrders; ++id) {
+    bool buy = rng() & 1;
+    std::int64_t offset = static_cast<std::int64_t>(rng() % 8) - 2;
+    messages.push_back(Message{10'000 + (buy ? -offset : offset), static_cast<std::int32_t>(1 + rng() % 50),
+                               static_cast<std::uint8_t>(buy), id});
+    if (rng() % 4 == 0) messages.push_back(Message{0, 0, 0, id - rng() % 64});
+  }
+  return messages;
+}
+
+// The caller's decode loop. A zero volume is a cancel.
+template<typename Exchange>
+void Decode(Exchange& p_Exchange, SymbolId p_Symbol, const std::vector<Message>& p_Messages) {
+  for (const Message& message : p_Messages) {
+    if (message.volume == 0) {
+      p_Exchange.Cancel(p_Symbol, message.id);
+      continue;
+    }
+    Order::Operation side = message.buy ? Order::Operation::BUY : Order::Operation::SELL;
+    p_Exchange.Process(Order{"", Price{message.ticks}, message.volume, side, p_Symbol, message.id});
+  }
+}
+
+template<typename Exchange, typename Make>
+double Run(Make&& p_Make, const std::vector<Message>& p_Messages) {
+  std::uint64_t reports = 0;
+  double best = 1e30;
+  for (int round = 0; round < kRounds; ++round) {
+    auto exchange = p_Make();
+    Exchange& ref = *exchange;
+    ref.ConfigureBook("XYZ", BookConfig{BookType::FLAT, 100, 1 << 12});
+    SymbolId symbol = ref.RegisterSymbol("XYZ");
+
+    auto start = std::chrono::steady_clock::now();
+    Decode(ref, symbol, p_Messages);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (ns < best) best = ns;
+    ref.DrainReports([&](const ExecutionReport&) { ++reports; });
+  }
+  return best / static_cast<double>(p_Messages.size());
+}
+
+} // namespace
+
+int main() {
+  std::vector<Message> messages = MakeFlow();
+  using Engine = MatchingEngineFor<InstrumentClass::EQUITY>;
+  EngineConfig config{.instruments = InstrumentClass::EQUITY};
+
+  double dynamic = Run<IStockExchange>([&] { return IStockExchange::Create(config); }, messages);
+  double fixed = Run<StaticExchange<Engine>>([&] { return std::make_unique<Engine>(config); }, messages);
+  std::printf("virtual %6.1f ns/order\n", dynamic);
+  std::printf("static  %6.1f ns/order\n", fixed);
+  return 0;
+}
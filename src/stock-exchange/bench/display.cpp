@@ -0,0 +1,62 @@
+// Full-depth dump of a 100k-order book through the paged DisplayOrders: all
+// of it through a sink, and page by page into a 4 KB buffer as a UI would
+// pull it.
+//
+// build: g++ -O2 -std=c++20 -pthread -I.. display.cpp ../StockExchange.cpp ../ShardedStockExchange.cpp ../IStockExchange.cpp -o display
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "IStockExchange.h"
+
+namespace {
+
+constexpr int kOrders = 100'000;
+constexpr std::int64_t kSpread = 20'000; // ticks either side of the mid
+
+double Ms(std::chrono::steady_clock::time_point p_Start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - p_Start).count();
+}
+
+} // namespace
+
+int main() {
+  auto exchange = IStockExchange::Create(EngineConfig{.instruments = InstrumentClass::EQUITY});
+  exchange->ConfigureBook("XYZ", BookConfig{BookType::FLAT, 100, 1 << 16});
+  SymbolId symbol = exchange->RegisterSymbol("XYZ");
+  std::mt19937 rng(8);
+  for (int i = 0; i < kOrders; ++i) {
+    bool buy = i & 1;
+    std::int64_t offset = 1 + static_cast<std::int64_t>(rng() % kSpread);
+    exchange->Process(Order{"", Price{buy ? 100'000 - offset : 100'000 + offset}, 1 + static_cast<int>(rng() % 100),
+                            buy ? Order::Operation::BUY : Order::Operation::SELL, symbol, static_cast<OrderId>(i + 1)});
+  }
+  exchange->DrainReports([](const ExecutionReport&) {});
+
+  DisplayQuery query;
+  query.depth = SIZE_MAX;
+
+  std::size_t bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  exchange->DisplayOrders(query, [&](std::string_view p_Chunk) { bytes += p_Chunk.size(); });
+  std::printf("sink:  %zu bytes in %.2f ms\n", bytes, Ms(start));
+
+  std::array<char, 4096> buffer;
+  std::size_t pages = 0;
+  bytes = 0;
+  start = std::chrono::steady_clock::now();
+  for (;;) {
+    DisplayPage page = exchange->DisplayOrders(query, std::span<char>(buffer));
+    bytes += page.size;
+    ++pages;
+    if (page.next.done) break;
+    query.cursor = page.next;
+  }
+  double ms = Ms(start);
+  std::printf("pages: %zu bytes in %zu pages, %.2f ms (%.1f us/page)\n", bytes, pages, ms, 1000 * ms / pages);
+  return 0;
+}
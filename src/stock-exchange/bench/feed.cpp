@@ -0,0 +1,122 @@
+// L2 feed: what it costs the matcher with a consumer keeping up (best of
+// kRounds), and what happens in a burst that the consumer sleeps through,
+// with gaps and with conflation: the matcher's pace, what the consumer
+// gets afterwards, and whether it ends up with the right book.
+//
+// build: g++ -O2 -std=c++20 -pthread -I.. feed.cpp ../StockExchange.cpp ../ShardedStockExchange.cpp ../IStockExchange.cpp -o feed
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "MatchingEngine.h"
+
+namespace {
+
+constexpr int kOrders = 2'000'000;
+constexpr int kSymbols = 16;
+constexpr std::size_t kBatch = 64;
+constexpr int kRounds = 5;
+
+using Engine = MatchingEngineFor<InstrumentClass::EQUITY>;
+
+std::vector<Order> MakeFlow() {
+  std::vector<Order> orders;
+  orders.reserve(kOrders);
+  std::mt19937 rng(7);
+  for (int i = 0; i < kOrders; ++i) {
+    bool buy = rng() & 1;
+    std::int64_t offset = static_cast<std::int64_t>(rng() % 40) - 15; // crosses now and then
+    orders.push_back(Order{"", Price{buy ? 10'000 - offset : 10'000 + offset}, 1 + static_cast<int>(rng() % 100),
+                           buy ? Order::Operation::BUY : Order::Operation::SELL,
+                           static_cast<SymbolId>(rng() % kSymbols), kNoOrderId});
+  }
+  return orders;
+}
+
+void Register(Engine& p_Engine) {
+  for (int i = 0; i < kSymbols; ++i) p_Engine.RegisterSymbol("S" + std::to_string(i));
+}
+
+// Feeds p_Flow in batches; p_Drain says after which batches the consumer
+// drains. ns per order.
+template<typename Drain>
+double Run(Engine& p_Engine, const std::vector<Order>& p_Flow, Drain&& p_Drain) {
+  std::vector<Order> batch;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < p_Flow.size(); i += kBatch) {
+    batch.assign(p_Flow.begin() + i, p_Flow.begin() + std::min(i + kBatch, p_Flow.size()));
+    p_Engine.ProcessBatch(batch);
+    p_Engine.DrainReports([](const ExecutionReport&) {});
+    p_Drain(i / kBatch);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kOrders;
+}
+
+double KeepingUp(const std::vector<Order>& p_Flow, std::size_t p_Capacity) {
+  Engine engine(EngineConfig{.reportCapacity = 1 << 22, .feedCapacity = p_Capacity});
+  Register(engine);
+  return Run(engine, p_Flow, [&](std::size_t) { engine.DrainMarketData([](const LevelUpdate&) {}); });
+}
+
+// The consumer sleeps through the first half, then drains after every
+// batch, rebuilding the books from what it gets; at the end they're
+// checked against the engine's snapshots (on for both runs alike).
+void Burst(const std::vector<Order>& p_Flow, bool p_Conflate) {
+  Engine engine(EngineConfig{.reportCapacity = 1 << 22, .snapshotLevels = SIZE_MAX, .feedCapacity = 4096,
+                             .conflateFeed = p_Conflate});
+  Register(engine);
+  std::map<std::tuple<SymbolId, Order::Operation, Price>, std::int64_t> books;
+  std::vector<std::uint64_t> sequences(kSymbols, 0);
+  std::size_t updates = 0;
+  std::size_t gaps = 0;
+  auto consume = [&](const LevelUpdate& p_Update) {
+    ++updates;
+    if (p_Update.sequence != sequences[p_Update.symbol] + 1) ++gaps;
+    sequences[p_Update.symbol] = p_Update.sequence;
+    auto key = std::make_tuple(p_Update.symbol, p_Update.side, p_Update.price);
+    if (p_Update.action == LevelUpdate::Action::DELETE) {
+      books.erase(key);
+    } else {
+      books[key] = p_Update.volume;
+    }
+  };
+  std::size_t half = p_Flow.size() / kBatch / 2;
+  double ns = Run(engine, p_Flow, [&](std::size_t p_Batch) {
+    if (p_Batch >= half) engine.DrainMarketData(consume);
+  });
+
+  std::map<std::tuple<SymbolId, Order::Operation, Price>, std::int64_t> actual;
+  for (SymbolId symbol = 0; symbol < kSymbols; ++symbol) {
+    engine.ReadSnapshot(symbol, [&](const BookSnapshot& p_Snapshot) {
+      for (const LevelSummary& level : p_Snapshot.bids) actual[{symbol, Order::Operation::BUY, level.price}] = level.volume;
+      for (const LevelSummary& level : p_Snapshot.asks) actual[{symbol, Order::Operation::SELL, level.price}] = level.volume;
+    });
+  }
+  std::printf("burst, %-10s %6.1f ns/order, %8zu updates, %6zu gaps, books %s\n", p_Conflate ? "conflated:" : "gaps:",
+              ns, updates, gaps, books == actual ? "right" : "wrong");
+}
+
+} // namespace
+
+int main() {
+  std::vector<Order> flow = MakeFlow();
+  double off = 1e9;
+  double on = 1e9;
+  for (int round = 0; round < kRounds; ++round) {
+    off = std::min(off, KeepingUp(flow, 0));
+    on = std::min(on, KeepingUp(flow, 1 << 16));
+  }
+  std::printf("keeping up, no feed: %6.1f ns/order\n", off);
+  std::printf("keeping up, feed:    %6.1f ns/order\n", on);
+  Burst(flow, false);
+  Burst(flow, true);
+  return 0;
+}
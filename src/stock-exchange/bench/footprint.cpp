@@ -0,0 +1,58 @@
+// Memory per resting order: record sizes, and what a book holding 10M
+// resting orders actually allocates (order slabs + id index). Fails if that
+// is more than keeping them as public Orders in a std::list would take.
+//
+// build: g++ -O2 -std=c++20 -I.. footprint.cpp -o footprint
+
+#include <cstdint>
+#include <cstdio>
+
+#include "FlatHashMap.h"
+#include "IStockExchange.h"
+#include "OrderBook.h"
+
+namespace {
+
+constexpr std::size_t kResting = 10'000'000;
+
+double MiB(std::size_t p_Bytes) { return static_cast<double>(p_Bytes) / (1 << 20); }
+
+} // namespace
+
+int main() {
+  std::printf("sizeof(Order)        %3zu  (public, std::string + padding)\n", sizeof(Order));
+  std::printf("sizeof(RestingOrder) %3zu  (%zu per cache line in a RingLevel queue)\n", sizeof(RestingOrder),
+              64 / sizeof(RestingOrder));
+  std::printf("sizeof(OrderNode)    %3zu  (id, volume, time, 32-bit links + level, %zu per cache line in the default queue)\n",
+              sizeof(OrderNode), 64 / sizeof(OrderNode));
+
+  // what the engine keeps per symbol, filled with kResting orders that
+  // never cross: bids below 10'000 ticks, asks above
+  OrderPool pool;
+  FlatOrderBook book(pool, 4096);
+  FlatHashMap<OrderId, PriceLevel::Handle, kNoOrderId> index(kResting);
+  for (std::size_t i = 0; i < kResting; ++i) {
+    bool buy = i & 1;
+    std::int64_t ticks = buy ? 9'999 - static_cast<std::int64_t>(i % 1000) : 10'001 + static_cast<std::int64_t>(i % 1000);
+    RestingOrder order{i + 1, Price{ticks}, 100, 0, static_cast<std::uint32_t>(i),
+                       buy ? Order::Operation::BUY : Order::Operation::SELL};
+    index.Insert(order.id, *book.Add(order).rested);
+  }
+
+  std::size_t total = pool.Bytes() + index.Bytes();
+  std::printf("\n%zu resting orders\n", kResting);
+  std::printf("  order slabs %8.1f MiB\n", MiB(pool.Bytes()));
+  std::printf("  id index    %8.1f MiB\n", MiB(index.Bytes()));
+  std::printf("  total       %8.1f MiB  (%.1f bytes/order)\n", MiB(total),
+              static_cast<double>(total) / kResting);
+
+  // the same orders kept as public Orders in a std::list, for scale
+  // (estimate: list links + Order only, no malloc headers and no id index)
+  std::size_t naive = kResting * (sizeof(Order) + 2 * sizeof(void*));
+  std::printf("  std::list<Order> would be at least %.1f MiB\n", MiB(naive));
+  if (total >= naive) {
+    std::printf("FAIL: the book takes more than the naive list\n");
+    return 1;
+  }
+  return 0;
+}
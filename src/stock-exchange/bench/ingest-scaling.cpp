@@ -0,0 +1,71 @@
+// Multi-gateway ingest: 1..16 producer threads calling Process on one
+// matcher, LOCKED vs MPSC inbox. Reports total throughput and the p99 time a
+// producer spends inside Process (i.e. enqueueing).
+//
+// build: g++ -O2 -std=c++20 -pthread -I.. ingest-scaling.cpp ../StockExchange.cpp ../ShardedStockExchange.cpp ../IStockExchange.cpp -o ingest-scaling
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "IStockExchange.h"
+
+namespace {
+
+constexpr int kOrdersPerProducer = 200'000;
+constexpr int kSymbols = 64;
+
+void Run(const char* p_Name, IngestMode p_Mode, int p_Producers) {
+  std::vector<std::vector<std::uint32_t>> latencies(p_Producers);
+  std::chrono::steady_clock::duration elapsed;
+  {
+    auto exchange = IStockExchange::Create(EngineConfig{1, p_Mode, 65536});
+    std::vector<SymbolId> symbols;
+    for (int i = 0; i < kSymbols; ++i) symbols.push_back(exchange->RegisterSymbol("S" + std::to_string(i)));
+
+    std::vector<std::thread> producers;
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < p_Producers; ++p) {
+      producers.emplace_back([&, p]() {
+        std::vector<std::uint32_t>& samples = latencies[p];
+        samples.reserve(kOrdersPerProducer);
+        for (int i = 0; i < kOrdersPerProducer; ++i) {
+          bool buy = (i + p) & 1;
+          Order order{"", Price{10'000 + (buy ? -(i % 8) : i % 8)}, 100,
+                      buy ? Order::Operation::BUY : Order::Operation::SELL,
+                      symbols[(i * 31 + p) % kSymbols]};
+          auto before = std::chrono::steady_clock::now();
+          exchange->Process(std::move(order));
+          auto after = std::chrono::steady_clock::now();
+          samples.push_back(static_cast<std::uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count()));
+        }
+      });
+    }
+    for (auto& producer : producers) producer.join();
+    exchange.reset(); // waits for the matcher to drain everything
+    elapsed = std::chrono::steady_clock::now() - start;
+  }
+
+  std::vector<std::uint32_t> all;
+  for (auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+  auto p99 = all.begin() + static_cast<std::ptrdiff_t>(all.size() * 99 / 100);
+  std::nth_element(all.begin(), p99, all.end());
+
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  std::printf("%-6s %2d producers %8.2f M orders/s   p99 enqueue %7u ns\n", p_Name, p_Producers,
+              static_cast<double>(all.size()) / seconds / 1e6, *p99);
+}
+
+} // namespace
+
+int main() {
+  for (int producers : {1, 2, 4, 8, 16}) {
+    Run("locked", IngestMode::LOCKED, producers);
+    Run("mpsc", IngestMode::MPSC, producers);
+  }
+  return 0;
+}
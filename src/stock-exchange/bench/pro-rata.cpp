@@ -0,0 +1,58 @@
+// FIFO vs pro-rata matching on one deep level: the level is refilled with
+// kDepth orders of random size, then a single buy takes about half of it.
+// FIFO stops after the first half of the queue; pro-rata has to read all of
+// it and touches every order, so this is its worst case relative to FIFO.
+//
+// build: g++ -O2 -std=c++20 -I.. pro-rata.cpp -o pro-rata
+// (add -march=native for the AVX2 allocation pass)
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "BookPolicy.h"
+
+namespace {
+
+constexpr int kRounds = 2'000;
+
+template<typename Matching>
+void Run(const char* p_Name, int p_Depth) {
+  using Book = typename BookPolicy<FlatSide, RingLevel, Matching>::Book;
+  RingStorage storage;
+  Book book(storage, std::size_t{1024});
+  std::mt19937 rng(9);
+  OrderId nextId = 1;
+  std::uint64_t fills = 0;
+  auto onFill = [&](const RestingOrder&, int) { ++fills; };
+
+  double total = 0;
+  for (int round = 0; round < kRounds; ++round) {
+    int resting = 0;
+    for (int i = 0; i < p_Depth; ++i) {
+      int volume = 1 + static_cast<int>(rng() % 100);
+      book.Add(RestingOrder{nextId++, Price{10'000}, volume, 0, 0, Order::Operation::SELL});
+      resting += volume;
+    }
+    RestingOrder buy{nextId++, Price{10'000}, resting / 2, 0, 0, Order::Operation::BUY};
+    auto start = std::chrono::steady_clock::now();
+    book.Add(buy, onFill);
+    total += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    // clear the rest of the level for the next round
+    book.Add(RestingOrder{nextId++, Price{10'000}, resting - resting / 2, 0, 0, Order::Operation::BUY});
+  }
+  std::printf("%-8s depth %5d: %9.1f ns/aggressor %6.2f ns/resting order  (%llu fills)\n", p_Name, p_Depth,
+              total / kRounds, total / kRounds / p_Depth, static_cast<unsigned long long>(fills));
+}
+
+} // namespace
+
+int main() {
+  for (int depth : {16, 256, 4'096}) {
+    Run<FifoMatching>("fifo", depth);
+    Run<ProRataMatching>("pro-rata", depth);
+  }
+  return 0;
+}
@@ -0,0 +1,116 @@
+// Linked-list (PriceLevel) vs contiguous ring (RingLevel) level queues under
+// a cancel-heavy flow: most orders are cancelled before they ever trade, as
+// on a real venue, and the rest are swept by marketable orders.
+//
+// build: g++ -O2 -std=c++20 -I.. queue-layout.cpp -o queue-layout
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "FlatHashMap.h"
+#include "OrderBook.h"
+#include "PerfCounter.h"
+
+namespace {
+
+constexpr int kOps = 4'000'000;
+// Most passive orders are cancelled, at about 20 cancels per marketable
+// order: (1 - 1/kMarketableEvery) * kCancelRatio * kMarketableEvery ~ 20.
+constexpr double kCancelRatio = 0.95; // cancels per new passive order
+constexpr unsigned kMarketableEvery = 22;
+constexpr int kMarketableVolume = 400; // passive orders are 1-100
+
+struct Op {
+  enum class Type : std::uint8_t { ADD, CANCEL } type;
+  RestingOrder order; // for CANCEL only order.id matters
+};
+
+// Passive orders a few ticks around a drifting mid, a cancel for a random
+// live order with probability kCancelRatio after each one, and one time in
+// kMarketableEvery a marketable order that takes out the top of the book.
+std::vector<Op> MakeFlow() {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+  std::vector<Op> ops;
+  ops.reserve(kOps);
+  std::vector<OrderId> live;
+  std::int64_t mid = 10'000;
+  OrderId nextId = 1;
+  while (ops.size() < kOps) {
+    if (rng() % 256 == 0) mid += static_cast<std::int64_t>(rng() % 3) - 1;
+    bool buy = rng() & 1;
+    Order::Operation side = buy ? Order::Operation::BUY : Order::Operation::SELL;
+    if (rng() % kMarketableEvery == 0) {
+      std::int64_t ticks = mid + (buy ? 3 : -3);
+      ops.push_back(Op{Op::Type::ADD, RestingOrder{nextId++, Price{ticks}, kMarketableVolume, 0, 0, side}});
+      continue;
+    }
+    std::int64_t ticks = mid + (buy ? -1 : 1) * static_cast<std::int64_t>(1 + rng() % 8);
+    ops.push_back(Op{Op::Type::ADD, RestingOrder{nextId, Price{ticks}, static_cast<int>(1 + rng() % 100), 0, 0, side}});
+    live.push_back(nextId++);
+    if (coin(rng) < kCancelRatio && !live.empty()) {
+      std::size_t pick = rng() % live.size();
+      ops.push_back(Op{Op::Type::CANCEL, RestingOrder{live[pick], {}, 0, 0, 0, side}});
+      live[pick] = live.back();
+      live.pop_back();
+    }
+  }
+  return ops;
+}
+
+template<typename Book, typename Storage>
+void Run(const char* p_Name, Storage& p_Storage, const std::vector<Op>& p_Ops) {
+  using Handle = typename Book::Handle;
+  Book book(p_Storage, std::size_t{4096});
+  FlatHashMap<OrderId, Handle, kNoOrderId> index(kOps);
+  std::uint64_t traded = 0;
+  auto onFill = [&](const RestingOrder& p_Resting, int p_Qty) {
+    traded += static_cast<std::uint64_t>(p_Qty);
+    if (p_Resting.volume == 0) index.Erase(p_Resting.id);
+  };
+  auto onMove = [&](OrderId p_Id, const Handle& p_Handle) { *index.Find(p_Id) = p_Handle; };
+
+  PerfCounter misses;
+  auto start = std::chrono::steady_clock::now();
+  misses.Start();
+  for (const Op& op : p_Ops) {
+    if (op.type == Op::Type::ADD) {
+      auto result = book.Add(op.order, onFill);
+      if (result.rested) index.Insert(op.order.id, *result.rested);
+    } else if (Handle* handle = index.Find(op.order.id)) {
+      Handle copy = *handle;
+      index.Erase(op.order.id);
+      book.Cancel(copy, onMove);
+    }
+  }
+  std::uint64_t missCount = misses.Stop();
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kOps;
+
+  if (misses.Valid()) {
+    std::printf("%-5s %7.1f ns/op %7.2f cache misses/op  (traded %llu)\n", p_Name, ns,
+                static_cast<double>(missCount) / kOps, static_cast<unsigned long long>(traded));
+  } else {
+    std::printf("%-5s %7.1f ns/op  (traded %llu)\n", p_Name, ns, static_cast<unsigned long long>(traded));
+  }
+}
+
+} // namespace
+
+int main() {
+  std::vector<Op> ops = MakeFlow();
+  std::size_t cancels = 0;
+  for (const Op& op : ops) cancels += op.type == Op::Type::CANCEL;
+  std::size_t marketable = 0;
+  for (const Op& op : ops) marketable += op.type == Op::Type::ADD && op.order.volume == kMarketableVolume;
+  std::printf("%zu ops: %.1f%% of passive orders cancelled, %.1f cancels per marketable order\n", ops.size(),
+              100.0 * static_cast<double>(cancels) / static_cast<double>(ops.size() - cancels - marketable),
+              static_cast<double>(cancels) / static_cast<double>(marketable));
+  OrderPool pool;
+  RingStorage rings;
+  Run<FlatOrderBook>("list", pool, ops);
+  Run<FlatRingOrderBook>("ring", rings, ops);
+  return 0;
+}
@@ -0,0 +1,115 @@
+// Quote publication: what it adds to the matcher (best of kRounds, with
+// and without a quote board), and what a read costs with the matcher idle
+// and with it rewriting the quotes being read.
+//
+// build: g++ -O2 -std=c++20 -pthread -I.. quote.cpp ../StockExchange.cpp ../ShardedStockExchange.cpp ../IStockExchange.cpp -o quote
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MatchingEngine.h"
+
+namespace {
+
+constexpr int kOrders = 2'000'000;
+constexpr int kSymbols = 16;
+constexpr int kReads = 20'000'000;
+constexpr int kRounds = 5;
+
+using Engine = MatchingEngineFor<InstrumentClass::EQUITY>;
+
+std::vector<Order> MakeFlow() {
+  std::vector<Order> orders;
+  orders.reserve(kOrders);
+  std::mt19937 rng(5);
+  for (int i = 0; i < kOrders; ++i) {
+    bool buy = rng() & 1;
+    std::int64_t offset = static_cast<std::int64_t>(rng() % 40) - 15; // crosses now and then
+    orders.push_back(Order{"", Price{buy ? 10'000 - offset : 10'000 + offset}, 1 + static_cast<int>(rng() % 100),
+                           buy ? Order::Operation::BUY : Order::Operation::SELL,
+                           static_cast<SymbolId>(rng() % kSymbols), kNoOrderId});
+  }
+  return orders;
+}
+
+void Register(Engine& p_Engine) {
+  for (int i = 0; i < kSymbols; ++i) p_Engine.RegisterSymbol("S" + std::to_string(i));
+}
+
+// ns per order with and without a quote board
+double Match(const std::vector<Order>& p_Flow, std::size_t p_QuoteSymbols) {
+  Engine engine(EngineConfig{.reportCapacity = 1 << 22, .quoteSymbols = p_QuoteSymbols});
+  Register(engine);
+  auto start = std::chrono::steady_clock::now();
+  for (const Order& order : p_Flow) {
+    engine.Process(Order(order));
+    engine.DrainReports([](const ExecutionReport&) {});
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kOrders;
+}
+
+// ns per read, on p_Readers threads, while p_Matching keeps the matcher busy
+void Read(const std::vector<Order>& p_Flow, int p_Readers, bool p_Matching) {
+  Engine engine;
+  Register(engine);
+  for (int i = 0; i < 10'000; ++i) engine.Process(Order(p_Flow[i]));
+  engine.DrainReports([](const ExecutionReport&) {});
+
+  std::atomic<bool> stop{false};
+  std::thread matcher;
+  if (p_Matching) {
+    matcher = std::thread([&] {
+      for (std::size_t i = 0; !stop.load(std::memory_order_relaxed); i = (i + 1) % p_Flow.size()) {
+        engine.Process(Order(p_Flow[i]));
+        engine.DrainReports([](const ExecutionReport&) {});
+      }
+    });
+  }
+  std::vector<double> ns(p_Readers);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < p_Readers; ++r) {
+    readers.emplace_back([&, r] {
+      std::int64_t checksum = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < kReads; ++i) {
+        Quote quote = *engine.ReadQuote(static_cast<SymbolId>(i % kSymbols));
+        checksum += quote.bidVolume + static_cast<std::int64_t>(quote.sequence);
+      }
+      ns[r] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kReads;
+      if (checksum == 42) std::puts("");
+    });
+  }
+  for (auto& reader : readers) reader.join();
+  stop = true;
+  if (matcher.joinable()) matcher.join();
+  double total = 0;
+  for (double n : ns) total += n;
+  std::printf("read, %d reader%s, matcher %s: %6.1f ns\n", p_Readers, p_Readers == 1 ? " " : "s",
+              p_Matching ? "busy" : "idle", total / p_Readers);
+}
+
+} // namespace
+
+int main() {
+  std::vector<Order> flow = MakeFlow();
+  double plain = 1e9;
+  double quoted = 1e9;
+  for (int round = 0; round < kRounds; ++round) {
+    plain = std::min(plain, Match(flow, 0));
+    quoted = std::min(quoted, Match(flow, 4096));
+  }
+  std::printf("match, no quotes:   %6.1f ns/order\n", plain);
+  std::printf("match, with quotes: %6.1f ns/order\n", quoted);
+  for (bool matching : {false, true}) {
+    for (int readers : {1, 4}) Read(flow, readers, matching);
+  }
+  return 0;
+}
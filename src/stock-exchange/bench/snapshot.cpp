@@ -0,0 +1,114 @@
+// Book snapshots: what publishing them after every batch costs the matcher
+// at a few depths (best of kRounds), and what reading one costs while the
+// matcher keeps replacing it.
+//
+// build: g++ -O2 -std=c++20 -pthread -I.. snapshot.cpp ../StockExchange.cpp ../ShardedStockExchange.cpp ../IStockExchange.cpp -o snapshot
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MatchingEngine.h"
+
+namespace {
+
+constexpr int kOrders = 2'000'000;
+constexpr int kSymbols = 16;
+constexpr std::size_t kBatch = 64;
+constexpr int kReads = 2'000'000;
+constexpr int kRounds = 5;
+
+using Engine = MatchingEngineFor<InstrumentClass::EQUITY>;
+
+std::vector<Order> MakeFlow() {
+  std::vector<Order> orders;
+  orders.reserve(kOrders);
+  std::mt19937 rng(6);
+  for (int i = 0; i < kOrders; ++i) {
+    bool buy = rng() & 1;
+    std::int64_t offset = static_cast<std::int64_t>(rng() % 200) - 15; // ~185 levels a side, crossing now and then
+    orders.push_back(Order{"", Price{buy ? 10'000 - offset : 10'000 + offset}, 1 + static_cast<int>(rng() % 100),
+                           buy ? Order::Operation::BUY : Order::Operation::SELL,
+                           static_cast<SymbolId>(rng() % kSymbols), kNoOrderId});
+  }
+  return orders;
+}
+
+void Register(Engine& p_Engine) {
+  for (int i = 0; i < kSymbols; ++i) p_Engine.RegisterSymbol("S" + std::to_string(i));
+}
+
+// ns per order, fed in batches of kBatch
+double Match(const std::vector<Order>& p_Flow, std::size_t p_Levels) {
+  Engine engine(EngineConfig{.reportCapacity = 1 << 22, .snapshotLevels = p_Levels});
+  Register(engine);
+  std::vector<Order> batch;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < p_Flow.size(); i += kBatch) {
+    batch.assign(p_Flow.begin() + i, p_Flow.begin() + std::min(i + kBatch, p_Flow.size()));
+    engine.ProcessBatch(batch);
+    engine.DrainReports([](const ExecutionReport&) {});
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kOrders;
+}
+
+// ns per ReadSnapshot summing the top 10 levels of both sides
+void Read(const std::vector<Order>& p_Flow, bool p_Matching) {
+  Engine engine(EngineConfig{.snapshotLevels = SIZE_MAX});
+  Register(engine);
+  std::vector<Order> warmup(p_Flow.begin(), p_Flow.begin() + 100'000);
+  engine.ProcessBatch(warmup);
+  engine.DrainReports([](const ExecutionReport&) {});
+
+  std::atomic<bool> stop{false};
+  std::thread matcher;
+  if (p_Matching) {
+    matcher = std::thread([&] {
+      std::vector<Order> batch;
+      for (std::size_t i = 0; !stop.load(std::memory_order_relaxed); i = (i + kBatch) % (p_Flow.size() - kBatch)) {
+        batch.assign(p_Flow.begin() + i, p_Flow.begin() + i + kBatch);
+        engine.ProcessBatch(batch);
+        engine.DrainReports([](const ExecutionReport&) {});
+      }
+    });
+  }
+  std::int64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kReads; ++i) {
+    engine.ReadSnapshot(static_cast<SymbolId>(i % kSymbols), [&](const BookSnapshot& p_Snapshot) {
+      for (Order::Operation side : {Order::Operation::BUY, Order::Operation::SELL}) {
+        p_Snapshot.Depth(side, 10, [&](const LevelSummary& p_Level) { checksum += p_Level.volume; });
+      }
+    });
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kReads;
+  stop = true;
+  if (matcher.joinable()) matcher.join();
+  std::printf("read, matcher %s: %6.1f ns  (%lld)\n", p_Matching ? "busy" : "idle", ns,
+              static_cast<long long>(checksum));
+}
+
+} // namespace
+
+int main() {
+  std::vector<Order> flow = MakeFlow();
+  for (std::size_t levels : {std::size_t{0}, std::size_t{10}, std::size_t{100}, SIZE_MAX}) {
+    double best = 1e9;
+    for (int round = 0; round < kRounds; ++round) best = std::min(best, Match(flow, levels));
+    if (levels == SIZE_MAX) {
+      std::printf("match, full-depth snapshots: %6.1f ns/order\n", best);
+    } else {
+      std::printf("match, %3zu-level snapshots:  %6.1f ns/order\n", levels, best);
+    }
+  }
+  for (bool matching : {false, true}) Read(flow, matching);
+  return 0;
+}
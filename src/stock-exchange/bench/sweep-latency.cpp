@@ -0,0 +1,82 @@
+// Latency of Process() for large marketable orders that sweep many levels
+// and orders, against a deep book whose resting orders are scattered in
+// memory (as they are after a session of churn). Reports p50/p99/p99.9.
+//
+// build: g++ -O2 -std=c++20 -pthread -I.. sweep-latency.cpp ../StockExchange.cpp ../ShardedStockExchange.cpp ../IStockExchange.cpp -o sweep-latency
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "IStockExchange.h"
+
+namespace {
+
+constexpr int kSweeps = 2'000;
+constexpr int kLevels = 64;      // ask levels refilled before every sweep
+constexpr int kPerLevel = 64;    // orders per level
+constexpr int kChurn = 200'000;  // orders resting far away, to scatter the pool
+
+Order Make(SymbolId p_Symbol, std::int64_t p_Ticks, int p_Volume, Order::Operation p_Side, OrderId p_Id) {
+  return Order{"", Price{p_Ticks}, p_Volume, p_Side, p_Symbol, p_Id};
+}
+
+void Run(const char* p_Name, BookType p_Type) {
+  auto exchange = IStockExchange::Create();
+  exchange->ConfigureBook("XYZ", BookConfig{p_Type, 100, 1 << 16});
+  SymbolId symbol = exchange->RegisterSymbol("XYZ");
+  auto discard = [](const ExecutionReport&) {};
+
+  // deep passive bids, half of them cancelled again in random order, so the
+  // pool's free list hands out nodes all over the place
+  std::mt19937 rng(5);
+  OrderId nextId = 1;
+  std::vector<OrderId> churn;
+  for (int i = 0; i < kChurn; ++i) {
+    exchange->Process(Make(symbol, 5'000 - static_cast<std::int64_t>(rng() % 4'000), 10, Order::Operation::BUY, nextId));
+    churn.push_back(nextId++);
+  }
+  std::shuffle(churn.begin(), churn.end(), rng);
+  for (std::size_t i = 0; i < churn.size() / 2; ++i) exchange->Cancel(symbol, churn[i]);
+  exchange->DrainReports(discard);
+
+  std::vector<double> latencies;
+  latencies.reserve(kSweeps);
+  std::vector<Order> asks;
+  for (int sweep = 0; sweep < kSweeps; ++sweep) {
+    // refill the ask side level by level, interleaved, so neighbours in a
+    // queue aren't neighbours in memory
+    asks.clear();
+    for (int i = 0; i < kPerLevel; ++i) {
+      for (int level = 0; level < kLevels; ++level) {
+        asks.push_back(Make(symbol, 10'000 + level, 1 + static_cast<int>(rng() % 20), Order::Operation::SELL, nextId++));
+      }
+    }
+    for (Order& ask : asks) exchange->Process(std::move(ask));
+    exchange->DrainReports(discard);
+
+    auto start = std::chrono::steady_clock::now();
+    exchange->Process(Make(symbol, 10'000 + kLevels, 1 << 30, Order::Operation::BUY, nextId++));
+    latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    exchange->DrainReports(discard);
+    // the sweep's remainder rests as the best bid; take it out again
+    exchange->Cancel(symbol, nextId - 1);
+    exchange->DrainReports(discard);
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  auto at = [&](double p_Quantile) { return latencies[static_cast<std::size_t>(p_Quantile * (latencies.size() - 1))]; };
+  std::printf("%-5s sweep of %d orders: p50 %7.1f us  p99 %7.1f us  p99.9 %7.1f us\n", p_Name,
+              kLevels * kPerLevel, at(0.5), at(0.99), at(0.999));
+}
+
+} // namespace
+
+int main() {
+  Run("tree", BookType::TREE);
+  Run("flat", BookType::FLAT);
+  return 0;
+}
@@ -1,14 +1,47 @@
+// A few orders through the engine: the execution reports they get and the
+// book they leave behind. The tests are a separate program, see test/main.cpp.
+//
+// build: g++ -O2 -std=c++20 -pthread -I. main.cpp StockExchange.cpp ShardedStockExchange.cpp IStockExchange.cpp -o stock-exchange
+
 #include <iostream>
+#include <memory>
 
 #include "IStockExchange.h"
 
+namespace {
 
-int main() {
-
+const char* TypeName(ExecutionReport::Type p_Type) {
+  switch (p_Type) {
+    case ExecutionReport::Type::NEW: return "NEW";
+    case ExecutionReport::Type::PARTIAL_FILL: return "PARTIAL_FILL";
+    case ExecutionReport::Type::FILL: return "FILL";
+    case ExecutionReport::Type::REJECTED: return "REJECTED";
+    case ExecutionReport::Type::CANCELED: return "CANCELED";
+    case ExecutionReport::Type::REPLACED: return "REPLACED";
+  }
+  return "?";
 }
 
-#if 0
+} // namespace
+
 int main() {
+  std::unique_ptr<IStockExchange> stockExchange = IStockExchange::Create();
+  SymbolId aapl = stockExchange->RegisterSymbol("AAPL");
+  auto price = [&](double p_Price) { return stockExchange->ToPrice(aapl, p_Price); };
+
+  stockExchange->Process(Order{{}, price(100.50), 10, Order::Operation::SELL, aapl, 1});
+  stockExchange->Process(Order{{}, price(100.25), 5, Order::Operation::SELL, aapl, 2});
+  stockExchange->Process(Order{{}, price(99.75), 8, Order::Operation::BUY, aapl, 3});
+  stockExchange->Process(Order{{}, price(100.50), 12, Order::Operation::BUY, aapl, 4});
+  stockExchange->Modify(aapl, 3, 4, price(99.75));
+  stockExchange->Cancel(aapl, 1);
+
+  stockExchange->DrainReports([](const ExecutionReport& p_Report) {
+    std::cout << p_Report.sequence << ' ' << TypeName(p_Report.type) << " order " << p_Report.orderId << " qty "
+              << p_Report.quantity << " leaves " << p_Report.leaves << '\n';
+  });
+  std::cout << std::flush;
+  stockExchange->DisplayOrders();
 
   stockExchange->Test([]() {
     std::cout << "Test finished, callback triggered" << std::endl;
@@ -16,4 +49,3 @@ int main() {
 
   return 0;
 }
-#endif
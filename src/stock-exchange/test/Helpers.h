@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ExecutionReport.h"
+#include "IStockExchange.h"
+#include "LevelSummary.h"
+#include "Price.h"
+
+inline Order Limit(SymbolId p_Symbol, std::int64_t p_Ticks, int p_Volume, Order::Operation p_Side, OrderId p_Id) {
+  return Order{{}, Price{p_Ticks}, p_Volume, p_Side, p_Symbol, p_Id};
+}
+
+inline Order Buy(SymbolId p_Symbol, std::int64_t p_Ticks, int p_Volume, OrderId p_Id = kNoOrderId) {
+  return Limit(p_Symbol, p_Ticks, p_Volume, Order::Operation::BUY, p_Id);
+}
+
+inline Order Sell(SymbolId p_Symbol, std::int64_t p_Ticks, int p_Volume, OrderId p_Id = kNoOrderId) {
+  return Limit(p_Symbol, p_Ticks, p_Volume, Order::Operation::SELL, p_Id);
+}
+
+// Every report pending right now, oldest first.
+inline std::vector<ExecutionReport> Reports(IStockExchange& p_Exchange) {
+  std::vector<ExecutionReport> reports;
+  p_Exchange.DrainReports([&](const ExecutionReport& p_Report) { reports.push_back(p_Report); });
+  return reports;
+}
+
+// For threaded engines: drain until p_Count reports came in, or give up
+// after a few seconds (and return what there is).
+inline std::vector<ExecutionReport> Reports(IStockExchange& p_Exchange, std::size_t p_Count) {
+  std::vector<ExecutionReport> reports;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (reports.size() < p_Count && std::chrono::steady_clock::now() < deadline) {
+    if (p_Exchange.DrainReports([&](const ExecutionReport& p_Report) { reports.push_back(p_Report); }) == 0) {
+      std::this_thread::yield();
+    }
+  }
+  return reports;
+}
+
+// Retry p_Check until it holds or a few seconds pass; for state a shard
+// publishes some time after its reports.
+template<typename Check>
+bool Eventually(Check&& p_Check) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!p_Check()) {
+    if (std::chrono::steady_clock::now() >= deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// What a book should hold, rebuilt from the orders sent and the reports
+// they got: each order's side and price, and its volume as the last report
+// about it left it. Levels are then summed from scratch.
+class ShadowBook {
+public:
+  // p_Order as sent; call before its reports come back
+  void Sent(const Order& p_Order) { m_Orders[p_Order.id] = Entry{p_Order.operation, p_Order.price, 0}; }
+
+  void Apply(const ExecutionReport& p_Report) {
+    auto it = m_Orders.find(p_Report.orderId);
+    if (it == m_Orders.end()) return;
+    switch (p_Report.type) {
+      case ExecutionReport::Type::NEW:
+      case ExecutionReport::Type::PARTIAL_FILL:
+      case ExecutionReport::Type::FILL:
+        it->second.volume = p_Report.leaves;
+        break;
+      case ExecutionReport::Type::REPLACED:
+        // at the new price, which the report carries
+        it->second.price = p_Report.price;
+        it->second.volume = p_Report.leaves;
+        break;
+      case ExecutionReport::Type::CANCELED:
+        it->second.volume = 0;
+        break;
+      case ExecutionReport::Type::REJECTED:
+        break;
+    }
+  }
+
+  // p_Side's levels, best first
+  std::vector<LevelSummary> Levels(Order::Operation p_Side) const {
+    std::map<Price, LevelSummary> levels;
+    for (const auto& [id, entry] : m_Orders) {
+      if (entry.side != p_Side || entry.volume == 0) continue;
+      LevelSummary& level = levels[entry.price];
+      level.price = entry.price;
+      level.volume += entry.volume;
+      ++level.orders;
+    }
+    std::vector<LevelSummary> result;
+    for (const auto& [price, level] : levels) result.push_back(level);
+    if (p_Side == Order::Operation::BUY) std::reverse(result.begin(), result.end());
+    return result;
+  }
+
+private:
+  struct Entry {
+    Order::Operation side;
+    Price price;
+    int volume;
+  };
+
+  std::map<OrderId, Entry> m_Orders;
+};
+
+inline bool operator==(const LevelSummary& p_Left, const LevelSummary& p_Right) {
+  return p_Left.price == p_Right.price && p_Left.volume == p_Right.volume && p_Left.orders == p_Right.orders;
+}
@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "doctest.h"
+
+#include "Helpers.h"
+#include "IStockExchange.h"
+
+namespace {
+
+// One book per price formatting case: two decimals, none, three, a scale
+// that isn't a power of ten, and a negative price.
+std::unique_ptr<IStockExchange> Exchange() {
+  auto exchange = IStockExchange::Create();
+  auto add = [&](const std::string& p_Name, std::int64_t p_Scale) {
+    BookConfig config;
+    config.priceScale = p_Scale;
+    exchange->ConfigureBook(p_Name, config);
+    return exchange->RegisterSymbol(p_Name);
+  };
+  SymbolId aapl = add("AAPL", 100);
+  SymbolId msft = add("MSFT", 1);
+  SymbolId xyz = add("XYZ", 1000);
+  SymbolId odd = add("ODD", 4);
+  SymbolId neg = add("NEG", 100);
+  OrderId id = 1;
+  exchange->Process(Buy(aapl, 9950, 3, id++));
+  exchange->Process(Buy(aapl, 10000, 5, id++));
+  exchange->Process(Buy(aapl, 9950, 4, id++));
+  exchange->Process(Sell(aapl, 10125, 2, id++));
+  exchange->Process(Buy(msft, 42, 1, id++));
+  exchange->Process(Sell(xyz, 1005, 9, id++));
+  exchange->Process(Sell(odd, 10, 1, id++));
+  exchange->Process(Buy(neg, -50, 1, id++));
+  Reports(*exchange);
+  return exchange;
+}
+
+constexpr std::string_view kAll = "AAPL BUY 100.00 5 1\n"
+                                  "AAPL BUY 99.50 7 2\n"
+                                  "AAPL SELL 101.25 2 1\n"
+                                  "MSFT BUY 42 1 1\n"
+                                  "XYZ SELL 1.005 9 1\n"
+                                  "ODD SELL 2.5 1 1\n"
+                                  "NEG BUY -0.50 1 1\n";
+
+std::string Sink(IStockExchange& p_Exchange, const DisplayQuery& p_Query) {
+  std::string text;
+  p_Exchange.DisplayOrders(p_Query, [&](std::string_view p_Chunk) { text += p_Chunk; });
+  return text;
+}
+
+// every page of p_Query, written through a buffer of p_Size bytes
+std::vector<std::string> Pages(IStockExchange& p_Exchange, DisplayQuery p_Query, std::size_t p_Size) {
+  std::vector<std::string> pages;
+  std::vector<char> buffer(p_Size);
+  do {
+    DisplayPage page = p_Exchange.DisplayOrders(p_Query, buffer);
+    pages.emplace_back(buffer.data(), page.size);
+    p_Query.cursor = page.next;
+  } while (!p_Query.cursor.done && pages.size() < 100);
+  return pages;
+}
+
+} // namespace
+
+TEST_CASE("display writes every level, bids then asks, best first, in each book's price scale") {
+  auto exchange = Exchange();
+  CHECK(Sink(*exchange, DisplayQuery{}) == kAll);
+
+  std::vector<std::string> pages = Pages(*exchange, DisplayQuery{}, 4096);
+  REQUIRE(pages.size() == 1);
+  CHECK(pages[0] == kAll);
+}
+
+TEST_CASE("pages hold whole lines and pick up where the last one stopped") {
+  auto exchange = Exchange();
+  // from the longest line up
+  for (std::size_t size : {21, 22, 40, 64}) {
+    CAPTURE(size);
+    std::string text;
+    for (const std::string& page : Pages(*exchange, DisplayQuery{}, size)) {
+      CHECK(page.size() <= size);
+      if (!page.empty()) CHECK(page.back() == '\n');
+      text += page;
+    }
+    CHECK(text == kAll);
+  }
+}
+
+TEST_CASE("a buffer too small for a line gets nothing and the cursor stays") {
+  auto exchange = Exchange();
+  char buffer[8];
+  DisplayPage page = exchange->DisplayOrders(DisplayQuery{}, buffer);
+  CHECK(page.size == 0);
+  CHECK(!page.next.done);
+  CHECK(page.next.symbol == 0);
+  CHECK(page.next.level == 0);
+}
+
+TEST_CASE("display queries select by symbol, side and depth") {
+  auto exchange = Exchange();
+  DisplayQuery query;
+  query.symbol = "AAPL";
+  CHECK(Sink(*exchange, query) == "AAPL BUY 100.00 5 1\nAAPL BUY 99.50 7 2\nAAPL SELL 101.25 2 1\n");
+
+  query.side = Order::Operation::SELL;
+  CHECK(Sink(*exchange, query) == "AAPL SELL 101.25 2 1\n");
+
+  query.side = std::nullopt;
+  query.depth = 1;
+  CHECK(Sink(*exchange, query) == "AAPL BUY 100.00 5 1\nAAPL SELL 101.25 2 1\n");
+  std::string paged;
+  for (const std::string& page : Pages(*exchange, query, 22)) paged += page;
+  CHECK(paged == "AAPL BUY 100.00 5 1\nAAPL SELL 101.25 2 1\n");
+
+  query.symbol = "NONE";
+  CHECK(Sink(*exchange, query).empty());
+  CHECK(Pages(*exchange, query, 64) == std::vector<std::string>{""});
+}
+
+TEST_CASE("a page after the book changed shows it as it is now") {
+  auto exchange = Exchange();
+  SymbolId aapl = exchange->RegisterSymbol("AAPL");
+  DisplayQuery query;
+  query.symbol = "AAPL";
+  char buffer[20];
+  DisplayPage page = exchange->DisplayOrders(query, buffer);
+  CHECK(std::string_view(buffer, page.size) == "AAPL BUY 100.00 5 1\n");
+
+  // the level the page stopped at is gone: the next one resumes past its price
+  exchange->Process(Sell(aapl, 10000, 5, 100));
+  exchange->Process(Buy(aapl, 9900, 1, 101));
+  query.cursor = page.next;
+  std::string text;
+  exchange->DisplayOrders(query, [&](std::string_view p_Chunk) { text += p_Chunk; });
+  CHECK(text == "AAPL BUY 99.50 7 2\nAAPL BUY 99.00 1 1\nAAPL SELL 101.25 2 1\n");
+}
@@ -0,0 +1,413 @@
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "doctest.h"
+
+#include "BookSnapshot.h"
+#include "ExecutionReport.h"
+#include "Helpers.h"
+#include "IStockExchange.h"
+
+namespace {
+
+using Type = ExecutionReport::Type;
+
+// A report without its sequence number, for comparing engines.
+struct Report {
+  OrderId id;
+  std::int64_t ticks;
+  SymbolId symbol;
+  int quantity;
+  int leaves;
+  Type type;
+
+  bool operator==(const Report&) const = default;
+};
+
+std::vector<Report> Strip(const std::vector<ExecutionReport>& p_Reports) {
+  std::vector<Report> reports;
+  for (const ExecutionReport& report : p_Reports) {
+    reports.push_back(Report{report.orderId, report.price.ticks, report.symbol, report.quantity, report.leaves,
+                             report.type});
+  }
+  return reports;
+}
+
+std::unique_ptr<IStockExchange> Engine(InstrumentClass p_Instruments = InstrumentClass::MIXED,
+                                       std::size_t p_SnapshotLevels = 0) {
+  EngineConfig config;
+  config.instruments = p_Instruments;
+  config.expectedOrders = 1024;
+  config.quoteSymbols = 16;
+  config.snapshotLevels = p_SnapshotLevels;
+  return IStockExchange::Create(config);
+}
+
+// p_Symbol's snapshot levels, one side
+std::vector<LevelSummary> SnapshotLevels(const IStockExchange& p_Exchange, SymbolId p_Symbol,
+                                         Order::Operation p_Side) {
+  std::vector<LevelSummary> levels;
+  p_Exchange.ReadSnapshot(p_Symbol, [&](const BookSnapshot& p_Snapshot) {
+    levels = p_Side == Order::Operation::BUY ? p_Snapshot.bids : p_Snapshot.asks;
+  });
+  return levels;
+}
+
+} // namespace
+
+TEST_CASE("an order that crosses gets NEW, then a report per side of each fill") {
+  auto exchange = Engine();
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+  exchange->Process(Sell(sym, 100, 5, 1));
+  exchange->Process(Sell(sym, 101, 5, 2));
+  exchange->Process(Buy(sym, 101, 8, 3));
+
+  std::vector<ExecutionReport> reports = Reports(*exchange);
+  CHECK(Strip(reports) == std::vector<Report>{
+    {1, 100, sym, 0, 5, Type::NEW},
+    {2, 101, sym, 0, 5, Type::NEW},
+    {3, 101, sym, 0, 8, Type::NEW},
+    {3, 100, sym, 5, 3, Type::PARTIAL_FILL},
+    {1, 100, sym, 5, 0, Type::FILL},
+    {3, 101, sym, 3, 0, Type::FILL},
+    {2, 101, sym, 3, 2, Type::PARTIAL_FILL},
+  });
+  for (std::size_t i = 0; i < reports.size(); ++i) CHECK(reports[i].sequence == i);
+}
+
+TEST_CASE("orders are routed by name when they carry no symbol id") {
+  auto exchange = Engine();
+  exchange->Process(Order{"MSFT", Price{100}, 5, Order::Operation::SELL, kInvalidSymbol, 1});
+  SymbolId sym = exchange->RegisterSymbol("MSFT");
+  exchange->Process(Buy(sym, 100, 5, 2));
+  std::vector<Report> reports = Strip(Reports(*exchange));
+  REQUIRE(reports.size() == 4);
+  CHECK(reports[0].symbol == sym);
+  CHECK(reports[3] == Report{1, 100, sym, 5, 0, Type::FILL});
+}
+
+TEST_CASE("orders with no symbol, no volume, an unknown symbol id or a resting id are REJECTED") {
+  auto exchange = Engine();
+  CHECK(exchange->RegisterSymbol("") == kInvalidSymbol);
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+  exchange->Process(Buy(sym, 100, 5, 1));
+  Reports(*exchange);
+
+  exchange->Process(Order{"", Price{100}, 5, Order::Operation::BUY, kInvalidSymbol, 2});
+  exchange->Process(Buy(sym, 100, 0, 3));
+  exchange->Process(Buy(sym + 1000, 100, 5, 4));
+  exchange->Process(Sell(sym, 200, 5, 1));
+  std::vector<Report> reports = Strip(Reports(*exchange));
+  REQUIRE(reports.size() == 4);
+  for (const Report& report : reports) CHECK(report.type == Type::REJECTED);
+
+  // and left the book as it was
+  exchange->Process(Sell(sym, 100, 5, 5));
+  reports = Strip(Reports(*exchange));
+  REQUIRE(reports.size() == 3);
+  CHECK(reports[2] == Report{1, 100, sym, 5, 0, Type::FILL});
+}
+
+TEST_CASE("cancel and modify answer under the order's own symbol") {
+  auto exchange = Engine();
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+  SymbolId other = exchange->RegisterSymbol("MSFT");
+  exchange->Process(Sell(sym, 100, 5, 1));
+  exchange->Process(Sell(sym, 100, 5, 2));
+  exchange->Process(Sell(sym, 100, 5, 3));
+  Reports(*exchange);
+
+  SUBCASE("cancel") {
+    exchange->Cancel(sym, 2);
+    CHECK(Strip(Reports(*exchange)) == std::vector<Report>{{2, 100, sym, 0, 0, Type::CANCELED}});
+    exchange->Cancel(sym, 2);
+    exchange->Cancel(other, 1);
+    exchange->Cancel(sym, 99);
+    exchange->Cancel(sym, kNoOrderId);
+    std::vector<Report> reports = Strip(Reports(*exchange));
+    REQUIRE(reports.size() == 4);
+    for (const Report& report : reports) CHECK(report.type == Type::REJECTED);
+    CHECK(reports[1].symbol == other);
+
+    exchange->Process(Buy(sym, 100, 10, 4));
+    reports = Strip(Reports(*exchange));
+    REQUIRE(reports.size() == 5);
+    CHECK(reports[2] == Report{1, 100, sym, 5, 0, Type::FILL});
+    CHECK(reports[4] == Report{3, 100, sym, 5, 0, Type::FILL});
+  }
+
+  SUBCASE("a reduction keeps the queue position") {
+    exchange->Modify(sym, 1, 2, Price{100});
+    CHECK(Strip(Reports(*exchange)) == std::vector<Report>{{1, 100, sym, 0, 2, Type::REPLACED}});
+    exchange->Process(Buy(sym, 100, 4, 4));
+    std::vector<Report> reports = Strip(Reports(*exchange));
+    REQUIRE(reports.size() == 5);
+    CHECK(reports[2] == Report{1, 100, sym, 2, 0, Type::FILL});
+    CHECK(reports[4] == Report{2, 100, sym, 2, 3, Type::PARTIAL_FILL});
+  }
+
+  SUBCASE("more volume goes to the back of the queue") {
+    exchange->Modify(sym, 1, 6, Price{100});
+    CHECK(Strip(Reports(*exchange)) == std::vector<Report>{{1, 100, sym, 0, 6, Type::REPLACED}});
+    exchange->Process(Buy(sym, 100, 11, 4));
+    std::vector<Report> reports = Strip(Reports(*exchange));
+    REQUIRE(reports.size() == 7);
+    CHECK(reports[2].id == 2);
+    CHECK(reports[4].id == 3);
+    CHECK(reports[6] == Report{1, 100, sym, 1, 5, Type::PARTIAL_FILL});
+  }
+
+  SUBCASE("a new price loses priority and may trade right away") {
+    exchange->Process(Buy(sym, 98, 4, 4));
+    Reports(*exchange);
+    exchange->Modify(sym, 1, 5, Price{98});
+    CHECK(Strip(Reports(*exchange)) == std::vector<Report>{
+      {1, 98, sym, 0, 5, Type::REPLACED},
+      {1, 98, sym, 4, 1, Type::PARTIAL_FILL},
+      {4, 98, sym, 4, 0, Type::FILL},
+    });
+  }
+
+  SUBCASE("what can't apply is REJECTED and the order stays") {
+    exchange->Modify(sym, 1, 0, Price{100});
+    exchange->Modify(other, 1, 2, Price{100});
+    exchange->Modify(sym, 99, 2, Price{100});
+    std::vector<Report> reports = Strip(Reports(*exchange));
+    REQUIRE(reports.size() == 3);
+    for (const Report& report : reports) CHECK(report.type == Type::REJECTED);
+    exchange->Cancel(sym, 1);
+    CHECK(Strip(Reports(*exchange)) == std::vector<Report>{{1, 100, sym, 0, 0, Type::CANCELED}});
+  }
+}
+
+TEST_CASE("a flat book turns away prices outside its widest window") {
+  for (InstrumentClass instruments : {InstrumentClass::MIXED, InstrumentClass::EQUITY, InstrumentClass::PRO_RATA}) {
+    auto exchange = Engine(instruments);
+    BookConfig config;
+    config.type = BookType::FLAT;
+    config.levels = 64;
+    config.maxLevels = 1024;
+    exchange->ConfigureBook("AAPL", config);
+    SymbolId sym = exchange->RegisterSymbol("AAPL");
+
+    exchange->Process(Buy(sym, 10'000, 5, 1));
+    exchange->Process(Buy(sym, 10'000 + 500, 5, 2));
+    exchange->Process(Buy(sym, 10'000'000, 5, 3));
+    // any price for the other side, which is empty
+    exchange->Process(Sell(sym, 10'000'000, 5, 4));
+    std::vector<Report> reports = Strip(Reports(*exchange));
+    REQUIRE(reports.size() == 4);
+    CHECK(reports[0].type == Type::NEW);
+    CHECK(reports[1].type == Type::NEW);
+    CHECK(reports[2] == Report{3, 10'000'000, sym, 0, 0, Type::REJECTED});
+    CHECK(reports[3].type == Type::NEW);
+
+    // a modify out of range leaves the order where it was
+    exchange->Modify(sym, 1, 5, Price{-10'000'000});
+    CHECK(Strip(Reports(*exchange)) == std::vector<Report>{{1, -10'000'000, sym, 0, 0, Type::REJECTED}});
+    exchange->Cancel(sym, 1);
+    CHECK(Strip(Reports(*exchange)) == std::vector<Report>{{1, 10'000, sym, 0, 0, Type::CANCELED}});
+  }
+}
+
+TEST_CASE("a flat book configured with no width takes orders") {
+  auto exchange = Engine();
+  BookConfig config;
+  config.type = BookType::FLAT;
+  config.levels = 0;
+  exchange->ConfigureBook("AAPL", config);
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+  exchange->Process(Buy(sym, 100, 5, 1));
+  exchange->Process(Buy(sym, 90, 5, 2));
+  exchange->Process(Sell(sym, 90, 10, 3));
+  CHECK(Strip(Reports(*exchange)).back() == Report{2, 90, sym, 5, 0, Type::FILL});
+}
+
+TEST_CASE("a book's configuration only changes while it's empty") {
+  auto exchange = Engine();
+  BookConfig config;
+  config.priceScale = 1000;
+  exchange->ConfigureBook("AAPL", config);
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+  CHECK(exchange->ToPrice(sym, 1.5) == Price{1500});
+
+  exchange->Process(Buy(sym, 1500, 5, 1));
+  config.priceScale = 100;
+  exchange->ConfigureBook("AAPL", config);
+  CHECK(exchange->ToPrice(sym, 1.5) == Price{1500});
+
+  // nothing happens for a nameless symbol
+  exchange->ConfigureBook("", config);
+  CHECK(exchange->RegisterSymbol("") == kInvalidSymbol);
+
+  // or for a scale that prices can't be divided by
+  SymbolId msft = exchange->RegisterSymbol("MSFT");
+  for (std::int64_t scale : {0, -100}) {
+    config.priceScale = scale;
+    exchange->ConfigureBook("MSFT", config);
+    CHECK(exchange->ToPrice(msft, 1.5) == Price{150});
+  }
+  exchange->Process(Buy(msft, 150, 5, 2));
+  std::string shown;
+  exchange->DisplayOrders(DisplayQuery{}, [&](std::string_view p_Chunk) { shown += p_Chunk; });
+  CHECK(shown.find("1.50") != std::string::npos);
+}
+
+TEST_CASE("the report stream chains rings behind a slow consumer and counts what it loses past the backlog") {
+  ReportStream stream(8, 16);
+  for (OrderId id = 1; id <= 40; ++id) stream.Publish(ExecutionReport{0, id, Price{100}, 0, 0, 1, Type::NEW});
+  stream.Flush();
+
+  std::vector<ExecutionReport> reports;
+  auto consume = [&](const ExecutionReport& p_Report) { reports.push_back(p_Report); };
+  CHECK(stream.Drain(consume, 5) == 5);
+  // the ring and the backlog behind it, in order, with no more flushes;
+  // the rest is lost
+  CHECK(stream.Drain(consume, SIZE_MAX) == 19);
+  REQUIRE(reports.size() == 24);
+  for (std::size_t i = 0; i < reports.size(); ++i) CHECK(reports[i].sequence == i);
+  CHECK(stream.Dropped() == 16);
+
+  // the next one shows the gap
+  stream.Publish(ExecutionReport{0, 41, Price{100}, 0, 0, 1, Type::NEW});
+  stream.Flush();
+  reports.clear();
+  stream.Drain(consume, SIZE_MAX);
+  REQUIRE(reports.size() == 1);
+  CHECK(reports[0].sequence == 40);
+  CHECK(stream.LastSequence() == 40);
+}
+
+TEST_CASE("the report stream keeps pace with a consumer that drains now and then") {
+  ReportStream stream(8, 8);
+  std::vector<ExecutionReport> reports;
+  auto consume = [&](const ExecutionReport& p_Report) { reports.push_back(p_Report); };
+  // a second ring is chained and let go of many times
+  for (OrderId id = 1; id <= 100; ++id) {
+    stream.Publish(ExecutionReport{0, id, Price{100}, 0, 0, 1, Type::NEW});
+    if (id % 5 == 0) stream.Flush();
+    if (id % 6 == 0) stream.Drain(consume, SIZE_MAX);
+  }
+  stream.Drain(consume, SIZE_MAX);
+  REQUIRE(reports.size() == 100);
+  for (std::size_t i = 0; i < reports.size(); ++i) CHECK(reports[i].orderId == i + 1);
+  CHECK(stream.Dropped() == 0);
+}
+
+TEST_CASE("the report stream spills a full staging array without waiting for Flush") {
+  ReportStream stream(1024);
+  std::size_t published = 2 * ReportStream::kStaged + 5;
+  for (OrderId id = 1; id <= published; ++id) stream.Publish(ExecutionReport{0, id, Price{100}, 0, 0, 1, Type::NEW});
+
+  std::vector<ExecutionReport> reports;
+  auto consume = [&](const ExecutionReport& p_Report) { reports.push_back(p_Report); };
+  CHECK(stream.Drain(consume, SIZE_MAX) == 2 * ReportStream::kStaged);
+  stream.Flush();
+  CHECK(stream.Drain(consume, SIZE_MAX) == 5);
+  REQUIRE(reports.size() == published);
+  for (std::size_t i = 0; i < reports.size(); ++i) CHECK(reports[i].sequence == i);
+  CHECK(stream.Dropped() == 0);
+}
+
+TEST_CASE("every fill reaches a consumer that only drains at the end") {
+  for (IngestMode ingest : {IngestMode::SYNC, IngestMode::LOCKED, IngestMode::SPSC, IngestMode::MPSC}) {
+    CAPTURE(static_cast<int>(ingest));
+    EngineConfig config;
+    config.ingest = ingest;
+    config.reportCapacity = 8;
+    config.pinThreads = false;
+    auto exchange = IStockExchange::Create(config);
+    SymbolId sym = exchange->RegisterSymbol("AAPL");
+    // NEW for each, and a fill report per side for every buy
+    for (OrderId id = 1; id <= 12; ++id) {
+      exchange->Process(id % 2 ? Sell(sym, 100, 1, id) : Buy(sym, 100, 1, id));
+    }
+    std::vector<ExecutionReport> reports = Reports(*exchange, 24);
+    REQUIRE(reports.size() == 24);
+    for (std::size_t i = 0; i < reports.size(); ++i) CHECK(reports[i].sequence == i);
+    CHECK(exchange->DroppedReports() == 0);
+  }
+}
+
+TEST_CASE("a batch reports as the same orders one by one would, per symbol") {
+  std::mt19937 random(7);
+  std::vector<Order> orders;
+  for (OrderId id = 1; id <= 2000; ++id) {
+    auto sym = static_cast<SymbolId>(random() % 4);
+    auto ticks = static_cast<std::int64_t>(95 + random() % 10);
+    int volume = static_cast<int>(1 + random() % 20);
+    orders.push_back(random() % 2 ? Buy(sym, ticks, volume, id) : Sell(sym, ticks, volume, id));
+  }
+
+  auto one = Engine();
+  auto batch = Engine();
+  for (const char* name : {"A", "B", "C", "D"}) {
+    one->RegisterSymbol(name);
+    batch->RegisterSymbol(name);
+  }
+  for (Order order : orders) one->Process(std::move(order));
+  for (std::size_t i = 0; i < orders.size(); i += 100) {
+    std::vector<Order> chunk(orders.begin() + static_cast<std::ptrdiff_t>(i),
+                             orders.begin() + static_cast<std::ptrdiff_t>(i + 100));
+    batch->ProcessBatch(chunk);
+  }
+
+  auto bySymbol = [](const std::vector<ExecutionReport>& p_Reports) {
+    std::map<SymbolId, std::vector<Report>> reports;
+    for (const Report& report : Strip(p_Reports)) reports[report.symbol].push_back(report);
+    return reports;
+  };
+  CHECK(bySymbol(Reports(*one)) == bySymbol(Reports(*batch)));
+}
+
+TEST_CASE("the book always holds what the reports say is resting") {
+  for (InstrumentClass instruments : {InstrumentClass::MIXED, InstrumentClass::EQUITY, InstrumentClass::WIDE_RANGE,
+                                      InstrumentClass::PRO_RATA}) {
+    auto exchange = Engine(instruments, 1000);
+    BookConfig flat;
+    flat.type = BookType::FLAT;
+    flat.levels = 16;
+    exchange->ConfigureBook("B", flat);
+    SymbolId symbols[] = {exchange->RegisterSymbol("A"), exchange->RegisterSymbol("B")};
+
+    std::mt19937 random(11);
+    std::map<SymbolId, ShadowBook> shadows;
+    std::vector<std::pair<SymbolId, OrderId>> sent;
+    OrderId next = 1;
+    for (int step = 0; step < 5000; ++step) {
+      unsigned action = random() % 10;
+      if (action < 6 || sent.empty()) {
+        SymbolId sym = symbols[random() % 2];
+        auto ticks = static_cast<std::int64_t>(1000 + random() % 40);
+        int volume = static_cast<int>(1 + random() % 50);
+        Order order = random() % 2 ? Buy(sym, ticks, volume, next) : Sell(sym, ticks, volume, next);
+        shadows[sym].Sent(order);
+        sent.emplace_back(sym, next++);
+        exchange->Process(std::move(order));
+      } else {
+        auto [sym, id] = sent[random() % sent.size()];
+        if (action < 8) {
+          exchange->Cancel(sym, id);
+        } else {
+          exchange->Modify(sym, id, static_cast<int>(1 + random() % 50),
+                           Price{static_cast<std::int64_t>(1000 + random() % 40)});
+        }
+      }
+      for (const ExecutionReport& report : Reports(*exchange)) shadows[report.symbol].Apply(report);
+    }
+
+    for (SymbolId sym : symbols) {
+      for (Order::Operation side : {Order::Operation::BUY, Order::Operation::SELL}) {
+        CHECK(SnapshotLevels(*exchange, sym, side) == shadows[sym].Levels(side));
+      }
+      // and the two sides never cross
+      std::vector<LevelSummary> bids = shadows[sym].Levels(Order::Operation::BUY);
+      std::vector<LevelSummary> asks = shadows[sym].Levels(Order::Operation::SELL);
+      if (!bids.empty() && !asks.empty()) CHECK(bids.front().price < asks.front().price);
+    }
+  }
+}
@@ -0,0 +1,7 @@
+// The doctest runner for the suites next to it. Build and run from the
+// directory above:
+//
+// build: g++ -O2 -std=c++20 -pthread -I. test/*.cpp StockExchange.cpp ShardedStockExchange.cpp IStockExchange.cpp -o stock-exchange-tests
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
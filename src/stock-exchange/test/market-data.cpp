@@ -0,0 +1,332 @@
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "doctest.h"
+
+#include "BookSnapshot.h"
+#include "Helpers.h"
+#include "IStockExchange.h"
+#include "MarketData.h"
+#include "Quote.h"
+#include "Seqlock.h"
+
+namespace {
+
+using Action = LevelUpdate::Action;
+
+EngineConfig Config() {
+  EngineConfig config;
+  config.expectedOrders = 1024;
+  config.quoteSymbols = 4;
+  return config;
+}
+
+std::vector<LevelUpdate> Updates(IStockExchange& p_Exchange) {
+  std::vector<LevelUpdate> updates;
+  p_Exchange.DrainMarketData([&](const LevelUpdate& p_Update) { updates.push_back(p_Update); });
+  return updates;
+}
+
+bool Same(const LevelUpdate& p_Update, Order::Operation p_Side, std::int64_t p_Ticks, std::int64_t p_Volume,
+          std::uint32_t p_Orders, Action p_Action) {
+  return p_Update.side == p_Side && p_Update.price == Price{p_Ticks} && p_Update.volume == p_Volume &&
+         p_Update.orders == p_Orders && p_Update.action == p_Action;
+}
+
+struct Words {
+  std::uint64_t a, b, c, d, e, f;
+};
+
+} // namespace
+
+TEST_CASE("a seqlock hands back the last value stored") {
+  Seqlock<Words> lock;
+  CHECK(lock.Load().a == 0);
+  lock.Store(Words{1, 2, 3, 4, 5, 6});
+  CHECK(lock.Load().f == 6);
+  CHECK(lock.Peek().c == 3);
+}
+
+TEST_CASE("seqlock readers never see half a store") {
+  Seqlock<Words> lock;
+  constexpr std::uint64_t kStores = 200'000;
+  std::atomic<bool> done{false};
+  std::atomic<std::uint64_t> torn{0};
+  std::thread reader([&] {
+    std::uint64_t last = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      Words words = lock.Load();
+      if (words.a != words.b || words.a != words.c || words.a != words.d || words.a != words.e ||
+          words.a != words.f || words.a < last) {
+        torn.fetch_add(1);
+      }
+      last = words.a;
+    }
+  });
+  for (std::uint64_t i = 1; i <= kStores; ++i) lock.Store(Words{i, i, i, i, i, i});
+  done.store(true, std::memory_order_release);
+  reader.join();
+  CHECK(torn.load() == 0);
+  CHECK(lock.Load().f == kStores);
+}
+
+TEST_CASE("quotes follow the top of book and the last trade") {
+  auto exchange = IStockExchange::Create(Config());
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+  REQUIRE(exchange->ReadQuote(sym));
+  CHECK(exchange->ReadQuote(sym)->bidVolume == 0);
+
+  exchange->Process(Sell(sym, 101, 5, 1));
+  exchange->Process(Buy(sym, 99, 3, 2));
+  Quote quote = *exchange->ReadQuote(sym);
+  CHECK(quote.bid == Price{99});
+  CHECK(quote.bidVolume == 3);
+  CHECK(quote.ask == Price{101});
+  CHECK(quote.askVolume == 5);
+  CHECK(quote.lastQuantity == 0);
+  CHECK(quote.sequence == 1);
+
+  exchange->Process(Buy(sym, 101, 2, 3));
+  quote = *exchange->ReadQuote(sym);
+  CHECK(quote.askVolume == 3);
+  CHECK(quote.lastPrice == Price{101});
+  CHECK(quote.lastQuantity == 2);
+  // NEW, then the two fill reports
+  CHECK(quote.sequence == 4);
+
+  // a cancel moves the quote but leaves the last trade
+  exchange->Cancel(sym, 2);
+  quote = *exchange->ReadQuote(sym);
+  CHECK(quote.bidVolume == 0);
+  CHECK(quote.lastQuantity == 2);
+  CHECK(quote.sequence == 5);
+
+  CHECK(!exchange->ReadQuote(4));
+}
+
+TEST_CASE("snapshots hold the top levels as of the last report that changed them") {
+  EngineConfig config = Config();
+  SUBCASE("off by default") {
+    auto exchange = IStockExchange::Create(config);
+    SymbolId sym = exchange->RegisterSymbol("AAPL");
+    exchange->Process(Buy(sym, 99, 3, 1));
+    CHECK(!exchange->ReadSnapshot(sym, [](const BookSnapshot&) { FAIL("no snapshots"); }));
+  }
+
+  SUBCASE("on") {
+    config.snapshotLevels = 2;
+    auto exchange = IStockExchange::Create(config);
+    SymbolId sym = exchange->RegisterSymbol("AAPL");
+    CHECK(!exchange->ReadSnapshot(sym, [](const BookSnapshot&) {}));
+
+    exchange->Process(Buy(sym, 97, 1, 1));
+    exchange->Process(Buy(sym, 99, 3, 2));
+    exchange->Process(Buy(sym, 98, 2, 3));
+    exchange->Process(Buy(sym, 99, 4, 4));
+    exchange->Process(Sell(sym, 103, 6, 5));
+    BookSnapshot copy;
+    CHECK(exchange->ReadSnapshot(sym, [&](const BookSnapshot& p_Snapshot) { copy = p_Snapshot; }));
+    CHECK(copy.sequence == 4);
+    CHECK(copy.bids == std::vector<LevelSummary>{{Price{99}, 7, 2}, {Price{98}, 2, 1}});
+    CHECK(copy.asks == std::vector<LevelSummary>{{Price{103}, 6, 1}});
+
+    // resuming past a price, as a paged display does
+    std::vector<LevelSummary> rest;
+    copy.Depth(Order::Operation::BUY, 5, [&](const LevelSummary& p_Level) { rest.push_back(p_Level); }, Price{99});
+    CHECK(rest == std::vector<LevelSummary>{{Price{98}, 2, 1}});
+
+    // only the first quoteSymbols symbols are covered
+    for (const char* name : {"B", "C", "D", "E"}) exchange->RegisterSymbol(name);
+    exchange->Process(Buy(4, 99, 3, 6));
+    CHECK(!exchange->ReadSnapshot(4, [](const BookSnapshot&) {}));
+  }
+}
+
+TEST_CASE("snapshots stay whole while the matcher replaces them") {
+  EngineConfig config = Config();
+  config.snapshotLevels = 8;
+  auto exchange = IStockExchange::Create(config);
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+  exchange->Process(Buy(sym, 90, 10, 1));
+
+  // every order is 10 lots, so every level holds 10 per order
+  std::atomic<bool> done{false};
+  std::atomic<std::uint64_t> bad{0};
+  std::thread reader([&] {
+    std::uint64_t last = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      exchange->ReadSnapshot(sym, [&](const BookSnapshot& p_Snapshot) {
+        if (p_Snapshot.sequence < last) bad.fetch_add(1);
+        last = p_Snapshot.sequence;
+        for (std::size_t i = 0; i < p_Snapshot.bids.size(); ++i) {
+          const LevelSummary& level = p_Snapshot.bids[i];
+          if (level.volume != 10 * static_cast<std::int64_t>(level.orders)) bad.fetch_add(1);
+          if (i > 0 && !(level.price < p_Snapshot.bids[i - 1].price)) bad.fetch_add(1);
+        }
+      });
+    }
+  });
+  std::mt19937 random(3);
+  for (OrderId id = 2; id < 20'000; ++id) {
+    exchange->Process(Buy(sym, 90 + static_cast<std::int64_t>(random() % 16), 10, id));
+    if (id % 3 == 0) exchange->Cancel(sym, id - 1);
+    Reports(*exchange);
+  }
+  done.store(true, std::memory_order_release);
+  reader.join();
+  CHECK(bad.load() == 0);
+}
+
+TEST_CASE("the feed sends each level touched, once per batch, as the batch left it") {
+  EngineConfig config = Config();
+  config.feedCapacity = 64;
+  auto exchange = IStockExchange::Create(config);
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+  CHECK(Updates(*exchange).empty());
+
+  exchange->Process(Buy(sym, 100, 5, 1));
+  exchange->Process(Buy(sym, 100, 3, 2));
+  exchange->Process(Sell(sym, 102, 4, 3));
+  std::vector<LevelUpdate> updates = Updates(*exchange);
+  REQUIRE(updates.size() == 3);
+  CHECK(Same(updates[0], Order::Operation::BUY, 100, 5, 1, Action::ADD));
+  CHECK(Same(updates[1], Order::Operation::BUY, 100, 8, 2, Action::UPDATE));
+  CHECK(Same(updates[2], Order::Operation::SELL, 102, 4, 1, Action::ADD));
+  for (std::size_t i = 0; i < updates.size(); ++i) {
+    CHECK(updates[i].sequence == i + 1);
+    CHECK(updates[i].symbol == sym);
+  }
+
+  // a sweep: one update per level it went through, and one for its rest
+  exchange->Process(Sell(sym, 99, 10, 4));
+  updates = Updates(*exchange);
+  REQUIRE(updates.size() == 2);
+  CHECK(Same(updates[0], Order::Operation::BUY, 100, 0, 0, Action::DELETE));
+  CHECK(Same(updates[1], Order::Operation::SELL, 99, 2, 1, Action::ADD));
+
+  // a modify in place, then one that moves the order
+  exchange->Modify(sym, 3, 1, Price{102});
+  exchange->Modify(sym, 3, 1, Price{103});
+  updates = Updates(*exchange);
+  REQUIRE(updates.size() == 3);
+  CHECK(Same(updates[0], Order::Operation::SELL, 102, 1, 1, Action::UPDATE));
+  CHECK(Same(updates[1], Order::Operation::SELL, 102, 0, 0, Action::DELETE));
+  CHECK(Same(updates[2], Order::Operation::SELL, 103, 1, 1, Action::ADD));
+
+  // a level that came and went within one batch was never there
+  std::vector<Order> batch{Buy(sym, 95, 1, 5), Buy(sym, 96, 1, 6), Sell(sym, 96, 1, 7)};
+  exchange->ProcessBatch(batch);
+  updates = Updates(*exchange);
+  REQUIRE(updates.size() == 1);
+  CHECK(Same(updates[0], Order::Operation::BUY, 95, 1, 1, Action::ADD));
+  CHECK(updates[0].sequence == 9);
+}
+
+TEST_CASE("without conflation the feed drops what doesn't fit and the sequence jumps") {
+  EngineConfig config = Config();
+  config.feedCapacity = 4;
+  auto exchange = IStockExchange::Create(config);
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+
+  std::vector<Order> batch;
+  for (OrderId id = 1; id <= 10; ++id) batch.push_back(Buy(sym, 100 + static_cast<std::int64_t>(id), 1, id));
+  exchange->ProcessBatch(batch);
+  std::vector<LevelUpdate> updates = Updates(*exchange);
+  REQUIRE(updates.size() == 4);
+  for (std::size_t i = 0; i < updates.size(); ++i) CHECK(updates[i].sequence == i + 1);
+
+  exchange->Cancel(sym, 1);
+  updates = Updates(*exchange);
+  REQUIRE(updates.size() == 1);
+  CHECK(updates[0].sequence == 11);
+}
+
+TEST_CASE("with conflation a slow consumer still ends up with the book, with no more orders to push it") {
+  for (IngestMode ingest : {IngestMode::SYNC, IngestMode::LOCKED}) {
+    CAPTURE(ingest);
+    EngineConfig config = Config();
+    config.ingest = ingest;
+    config.pinThreads = false;
+    config.feedCapacity = 8;
+    config.conflateFeed = true;
+    config.snapshotLevels = 1000;
+    auto exchange = IStockExchange::Create(config);
+    SymbolId sym = exchange->RegisterSymbol("AAPL");
+
+    // the consumer's copy of the book, per side and price, taken a few
+    // updates at a time
+    std::map<std::pair<Order::Operation, Price>, LevelSummary> levels;
+    std::uint64_t sequence = 0;
+    bool gaps = false;
+    auto drain = [&] {
+      auto apply = [&](const LevelUpdate& p_Update) {
+        gaps |= p_Update.sequence != ++sequence;
+        auto key = std::make_pair(p_Update.side, p_Update.price);
+        if (p_Update.action == Action::DELETE) {
+          levels.erase(key);
+        } else {
+          levels[key] = LevelSummary{p_Update.price, p_Update.volume, p_Update.orders};
+        }
+      };
+      while (exchange->DrainMarketData(apply, 3) > 0) {}
+    };
+    auto book = [&] {
+      std::map<std::pair<Order::Operation, Price>, LevelSummary> book;
+      exchange->ReadSnapshot(sym, [&](const BookSnapshot& p_Snapshot) {
+        for (const LevelSummary& level : p_Snapshot.bids) book[{Order::Operation::BUY, level.price}] = level;
+        for (const LevelSummary& level : p_Snapshot.asks) book[{Order::Operation::SELL, level.price}] = level;
+      });
+      return book;
+    };
+
+    std::mt19937 random(5);
+    for (OrderId id = 1; id <= 5000; ++id) {
+      auto ticks = static_cast<std::int64_t>(100 + random() % 20);
+      int volume = static_cast<int>(1 + random() % 10);
+      exchange->Process(random() % 2 ? Buy(sym, ticks, volume, id) : Sell(sym, ticks, volume, id));
+      if (random() % 4 == 0) exchange->Cancel(sym, random() % id + 1);
+      // now and then, and less than the ring would need
+      if (random() % 50 == 0) drain();
+    }
+    // the matcher is done (or, threaded, will be soon and then sleeps):
+    // what it still holds comes out as the consumer drains
+    CHECK(Eventually([&] {
+      drain();
+      return !levels.empty() && levels == book();
+    }));
+    CHECK(!gaps);
+  }
+}
+
+TEST_CASE("with conflation a busy symbol can't keep a quiet one waiting") {
+  EngineConfig config = Config();
+  config.feedCapacity = 4;
+  config.conflateFeed = true;
+  auto exchange = IStockExchange::Create(config);
+  SymbolId busy = exchange->RegisterSymbol("BUSY");
+  std::vector<Order> batch;
+  for (OrderId id = 1; id <= 16; ++id) {
+    batch.push_back(Buy(exchange->RegisterSymbol("Q" + std::to_string(id)), 100, 1, id));
+  }
+  exchange->ProcessBatch(batch);
+
+  // every round, the busy symbol opens more levels than the ring takes
+  std::set<SymbolId> seen;
+  OrderId id = 100;
+  for (int round = 0; round < 8; ++round) {
+    for (const LevelUpdate& update : Updates(*exchange)) seen.insert(update.symbol);
+    batch.clear();
+    for (int i = 0; i < 4; ++i, ++id) batch.push_back(Buy(busy, static_cast<std::int64_t>(id), 1, id));
+    exchange->ProcessBatch(batch);
+  }
+  for (const LevelUpdate& update : Updates(*exchange)) seen.insert(update.symbol);
+  seen.erase(busy);
+  CHECK(seen.size() == 16);
+}
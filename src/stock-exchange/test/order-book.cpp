@@ -0,0 +1,359 @@
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "doctest.h"
+
+#include "BookPolicy.h"
+#include "FlatHashMap.h"
+#include "Helpers.h"
+#include "Matching.h"
+#include "OrderBook.h"
+#include "RingLevel.h"
+
+namespace {
+
+using ProRataBook = BasicOrderBook<FlatSide<std::greater<Price>, RingLevel, ProRataMatching>,
+                                   FlatSide<std::less<Price>, RingLevel, ProRataMatching>>;
+
+// a book with its own storage
+template<typename Book>
+struct Fixture {
+  typename Book::Storage storage;
+  Book book{storage};
+};
+
+RestingOrder Resting(OrderId p_Id, std::int64_t p_Ticks, int p_Volume, Order::Operation p_Side) {
+  return RestingOrder{p_Id, Price{p_Ticks}, p_Volume, 0, static_cast<std::uint32_t>(p_Id), p_Side};
+}
+
+struct Trade {
+  OrderId resting;
+  std::int64_t ticks;
+  int quantity;
+
+  bool operator==(const Trade&) const = default;
+};
+
+template<typename Book>
+std::vector<Trade> Add(Book& p_Book, const RestingOrder& p_Order) {
+  std::vector<Trade> trades;
+  p_Book.Add(p_Order, [&](const RestingOrder& p_Resting, int p_Qty) {
+    trades.push_back(Trade{p_Resting.id, p_Resting.price.ticks, p_Qty});
+  });
+  return trades;
+}
+
+template<typename Book>
+std::vector<LevelSummary> Depth(const Book& p_Book, Order::Operation p_Side, std::size_t p_Max = 100,
+                                std::optional<Price> p_After = std::nullopt) {
+  std::vector<LevelSummary> levels;
+  p_Book.Depth(p_Side, p_Max, [&](const LevelSummary& p_Level) { levels.push_back(p_Level); }, p_After);
+  return levels;
+}
+
+} // namespace
+
+#define BOOK_TYPES OrderBook, FlatOrderBook, RingOrderBook, FlatRingOrderBook
+
+TEST_CASE_TEMPLATE("books fill the best price first, then the oldest order", Book, BOOK_TYPES) {
+  Fixture<Book> f;
+  f.book.Add(Resting(1, 101, 5, Order::Operation::SELL));
+  f.book.Add(Resting(2, 100, 5, Order::Operation::SELL));
+  f.book.Add(Resting(3, 100, 5, Order::Operation::SELL));
+
+  std::vector<Trade> trades = Add(f.book, Resting(4, 101, 12, Order::Operation::BUY));
+  CHECK(trades == std::vector<Trade>{{2, 100, 5}, {3, 100, 5}, {1, 101, 2}});
+  CHECK(!f.book.BestBid());
+  REQUIRE(f.book.TopAsk());
+  CHECK(f.book.TopAsk()->price == Price{101});
+  CHECK(f.book.TopAsk()->volume == 3);
+}
+
+TEST_CASE_TEMPLATE("what doesn't cross rests at its limit", Book, BOOK_TYPES) {
+  Fixture<Book> f;
+  f.book.Add(Resting(1, 100, 5, Order::Operation::SELL));
+  auto result = f.book.Add(Resting(2, 99, 7, Order::Operation::BUY));
+  CHECK(result.filled == 0);
+  CHECK(result.rested);
+  CHECK(f.book.BestBid() == Price{99});
+  CHECK(f.book.BestAsk() == Price{100});
+
+  // partly filled, the rest becomes the new best bid
+  result = f.book.Add(Resting(3, 100, 8, Order::Operation::BUY));
+  CHECK(result.filled == 5);
+  CHECK(result.rested);
+  CHECK(f.book.BestBid() == Price{100});
+  CHECK(f.book.TopBid()->volume == 3);
+  CHECK(!f.book.BestAsk());
+}
+
+TEST_CASE_TEMPLATE("cancel and reduce keep the level totals and the queue order", Book, BOOK_TYPES) {
+  Fixture<Book> f;
+  auto first = f.book.Add(Resting(1, 100, 5, Order::Operation::SELL)).rested;
+  auto second = f.book.Add(Resting(2, 100, 7, Order::Operation::SELL)).rested;
+  f.book.Add(Resting(3, 100, 9, Order::Operation::SELL));
+  REQUIRE(first);
+  REQUIRE(second);
+
+  f.book.Reduce(*second, 2);
+  CHECK(f.book.At(*second).volume == 2);
+  CHECK(f.book.TopAsk()->volume == 16);
+  CHECK(f.book.TopAsk()->orders == 3);
+
+  f.book.Cancel(*first);
+  CHECK(f.book.TopAsk()->volume == 11);
+  CHECK(f.book.TopAsk()->orders == 2);
+
+  // the reduced order kept its place ahead of the third
+  CHECK(Add(f.book, Resting(4, 100, 4, Order::Operation::BUY)) == std::vector<Trade>{{2, 100, 2}, {3, 100, 2}});
+  CHECK(f.book.TopAsk()->volume == 7);
+  CHECK(f.book.TopAsk()->orders == 1);
+}
+
+TEST_CASE_TEMPLATE("handles stay good when a flat window moves its levels", Book, BOOK_TYPES) {
+  typename Book::Storage storage;
+  Book book = MakeBook<Book>(storage, BookConfig{BookType::FLAT, 100, 8, 1024});
+  auto first = book.Add(Resting(1, 100, 5, Order::Operation::SELL)).rested;
+  auto second = book.Add(Resting(2, 100, 7, Order::Operation::SELL)).rested;
+  REQUIRE(first);
+  REQUIRE(second);
+  // far outside the first window: a flat side re-centers and moves the level
+  book.Add(Resting(3, 400, 9, Order::Operation::SELL));
+
+  CHECK(book.At(*second).id == 2);
+  CHECK(book.At(*second).price == Price{100});
+  book.Cancel(*first);
+  CHECK(book.LevelAt(Order::Operation::SELL, Price{100}) == LevelSummary{Price{100}, 7, 1});
+  CHECK(Add(book, Resting(4, 400, 20, Order::Operation::BUY)) == std::vector<Trade>{{2, 100, 7}, {3, 400, 9}});
+}
+
+TEST_CASE_TEMPLATE("depth lists levels best first and resumes after a price", Book, BOOK_TYPES) {
+  Fixture<Book> f;
+  OrderId id = 1;
+  for (std::int64_t ticks : {95, 97, 99, 97}) f.book.Add(Resting(id++, ticks, 10, Order::Operation::BUY));
+  for (std::int64_t ticks : {101, 104, 101}) f.book.Add(Resting(id++, ticks, 3, Order::Operation::SELL));
+
+  CHECK(Depth(f.book, Order::Operation::BUY) ==
+        std::vector<LevelSummary>{{Price{99}, 10, 1}, {Price{97}, 20, 2}, {Price{95}, 10, 1}});
+  CHECK(Depth(f.book, Order::Operation::SELL) == std::vector<LevelSummary>{{Price{101}, 6, 2}, {Price{104}, 3, 1}});
+  CHECK(Depth(f.book, Order::Operation::BUY, 1) == std::vector<LevelSummary>{{Price{99}, 10, 1}});
+  CHECK(Depth(f.book, Order::Operation::BUY, 5, Price{99}) ==
+        std::vector<LevelSummary>{{Price{97}, 20, 2}, {Price{95}, 10, 1}});
+  // a resume point that isn't a level any more
+  CHECK(Depth(f.book, Order::Operation::BUY, 5, Price{98}) ==
+        std::vector<LevelSummary>{{Price{97}, 20, 2}, {Price{95}, 10, 1}});
+  CHECK(Depth(f.book, Order::Operation::SELL, 5, Price{104}).empty());
+
+  CHECK(f.book.LevelAt(Order::Operation::BUY, Price{97})->volume == 20);
+  CHECK(!f.book.LevelAt(Order::Operation::BUY, Price{98}));
+
+  // a cursor from anywhere, in the window or far outside it
+  constexpr std::int64_t kLowest = std::numeric_limits<std::int64_t>::min();
+  constexpr std::int64_t kHighest = std::numeric_limits<std::int64_t>::max();
+  CHECK(Depth(f.book, Order::Operation::BUY, 5, Price{kHighest}).size() == 3);
+  CHECK(Depth(f.book, Order::Operation::BUY, 5, Price{95}).empty());
+  CHECK(Depth(f.book, Order::Operation::BUY, 5, Price{kLowest}).empty());
+  CHECK(Depth(f.book, Order::Operation::SELL, 5, Price{kLowest}).size() == 2);
+  CHECK(Depth(f.book, Order::Operation::SELL, 5, Price{-5}).size() == 2);
+  CHECK(Depth(f.book, Order::Operation::SELL, 5, Price{kHighest}).empty());
+  for (std::int64_t ticks : {kLowest, std::int64_t{-1}, std::int64_t{1'000'000}, kHighest}) {
+    CHECK(!f.book.LevelAt(Order::Operation::BUY, Price{ticks}));
+    CHECK(!f.book.LevelAt(Order::Operation::SELL, Price{ticks}));
+  }
+
+  // stopping early
+  int seen = 0;
+  f.book.Depth(Order::Operation::BUY, 5, [&](const LevelSummary&) { return ++seen < 2; });
+  CHECK(seen == 2);
+}
+
+TEST_CASE_TEMPLATE("a level goes away with its last order, wherever it is", Book, BOOK_TYPES) {
+  Fixture<Book> f;
+  f.book.Add(Resting(1, 1000, 10, Order::Operation::BUY));
+  for (OrderId id = 2; id < 5000; ++id) {
+    auto rested = f.book.Add(Resting(id, 1000 - static_cast<std::int64_t>(id), 10, Order::Operation::BUY)).rested;
+    REQUIRE(rested);
+    f.book.Cancel(*rested);
+  }
+  CHECK(Depth(f.book, Order::Operation::BUY) == std::vector<LevelSummary>{{Price{1000}, 10, 1}});
+  CHECK(!f.book.LevelAt(Order::Operation::BUY, Price{998}));
+}
+
+TEST_CASE("tree levels are erased when a cancel empties them away from the front") {
+  OrderPool pool;
+  TreeSide<std::greater<Price>> bids(pool);
+  bids.Rest(Resting(1, 1000, 10, Order::Operation::BUY));
+  PriceLevel::Handle deep = bids.Rest(Resting(2, 900, 10, Order::Operation::BUY));
+  bids.Cancel(deep, [](OrderId, PriceLevel::Handle) {});
+  std::vector<LevelSummary> levels;
+  // asking for two would walk into an empty level if it were still there
+  bids.Depth(2, [&](const LevelSummary& p_Level) { levels.push_back(p_Level); });
+  CHECK(levels == std::vector<LevelSummary>{{Price{1000}, 10, 1}});
+  CHECK(pool.InUse() == 1);
+}
+
+TEST_CASE("flat sides only take prices their window can grow to cover") {
+  OrderPool pool;
+  FlatOrderBook book(pool, 64, 1024);
+  // an empty side takes anything
+  CHECK(book.Fits(Order::Operation::BUY, Price{1'000'000'000'000}));
+
+  auto first = book.Add(Resting(1, 10'000, 5, Order::Operation::BUY)).rested;
+  REQUIRE(first);
+  CHECK(book.Fits(Order::Operation::BUY, Price{10'000 + 1023}));
+  CHECK(!book.Fits(Order::Operation::BUY, Price{10'000 + 1024}));
+  CHECK(!book.Fits(Order::Operation::BUY, Price{100'000'000}));
+  CHECK(book.Fits(Order::Operation::SELL, Price{100'000'000}));
+
+  // growing to the limit keeps every level where it was
+  book.Add(Resting(2, 10'000 + 1023, 5, Order::Operation::BUY));
+  CHECK(Depth(book, Order::Operation::BUY) ==
+        std::vector<LevelSummary>{{Price{10'000 + 1023}, 5, 1}, {Price{10'000}, 5, 1}});
+
+  // only the levels still there count
+  book.Cancel(*first);
+  CHECK(book.Fits(Order::Operation::BUY, Price{10'000 + 1023 + 1000}));
+
+  OrderBook tree(pool);
+  tree.Add(Resting(3, 10'000, 5, Order::Operation::BUY));
+  CHECK(tree.Fits(Order::Operation::BUY, Price{100'000'000}));
+}
+
+TEST_CASE("a flat side configured with no width still grows") {
+  OrderPool pool;
+  FlatOrderBook book(pool, 0, 0);
+  book.Add(Resting(1, 100, 5, Order::Operation::BUY));
+  // the limit is at least the width, so a second level doesn't fit
+  CHECK(!book.Fits(Order::Operation::BUY, Price{101}));
+
+  FlatOrderBook wider(pool, 0, 64);
+  for (OrderId id = 1; id <= 40; ++id) wider.Add(Resting(id, 100 + static_cast<std::int64_t>(id), 1, Order::Operation::SELL));
+  CHECK(Depth(wider, Order::Operation::SELL).size() == 40);
+  CHECK(wider.BestAsk() == Price{101});
+}
+
+TEST_CASE("ring levels compact tombstones and report every move") {
+  RingStorage storage;
+  RingLevel level;
+  std::vector<QueueSlot> handles;
+  for (OrderId id = 1; id <= 40; ++id) handles.push_back(level.Rest(storage, Resting(id, 100, 1, Order::Operation::SELL)));
+
+  std::vector<std::pair<OrderId, QueueSlot>> moves;
+  auto onMove = [&](OrderId p_Id, const QueueSlot& p_Slot) { moves.emplace_back(p_Id, p_Slot); };
+  // cancel every order from the second on: no compaction until tombstones
+  // outnumber live orders, at the 21st
+  for (std::size_t i = 1; i <= 21; ++i) {
+    level.Cancel(storage, handles[i], onMove);
+    if (i < 21) CHECK(moves.empty());
+  }
+  CHECK(level.Count() == 19);
+  CHECK(level.Volume() == 19);
+  // the orders behind the tombstones moved up, each one reported
+  REQUIRE(moves.size() == 18);
+  for (std::size_t i = 0; i < moves.size(); ++i) {
+    CHECK(moves[i].first == 23 + i);
+    CHECK(level.At(storage, moves[i].second).id == moves[i].first);
+    handles[moves[i].first - 1] = moves[i].second;
+  }
+
+  // the new handles are the ones that work now
+  level.Cancel(storage, handles[29], onMove);
+  CHECK(level.Count() == 18);
+
+  // and the queue kept its order
+  std::vector<OrderId> filled;
+  level.Fill(storage, 100, [&](const RestingOrder& p_Resting, int) { filled.push_back(p_Resting.id); });
+  std::vector<OrderId> expected{1};
+  for (OrderId id = 23; id <= 40; ++id) {
+    if (id != 30) expected.push_back(id);
+  }
+  CHECK(filled == expected);
+  CHECK(level.Empty());
+}
+
+TEST_CASE("ring levels pop tombstones at the front and stay valid while growing") {
+  RingStorage storage;
+  RingLevel level;
+  QueueSlot first = level.Rest(storage, Resting(1, 100, 5, Order::Operation::BUY));
+  std::vector<QueueSlot> handles;
+  for (OrderId id = 2; id <= 100; ++id) handles.push_back(level.Rest(storage, Resting(id, 100, 1, Order::Operation::BUY)));
+  // handles from before the ring grew still find their orders
+  CHECK(level.At(storage, first).id == 1);
+  CHECK(level.At(storage, handles.back()).id == 100);
+
+  level.Cancel(storage, first, [](OrderId, const QueueSlot&) { FAIL("nothing should move"); });
+  CHECK(level.Front(storage)->id == 2);
+  CHECK(level.Count() == 99);
+}
+
+TEST_CASE("pro-rata shares follow the resting sizes and add up exactly") {
+  std::vector<int> volumes{10, 30, 60};
+  std::vector<int> shares;
+  ProRataMatching::Allocate(volumes, shares, 50, 100);
+  CHECK(shares[0] == 5);
+  CHECK(shares[1] == 15);
+  CHECK(shares[2] == 30);
+
+  // rounding leftovers go a lot at a time in time priority
+  volumes = {1, 1, 1};
+  ProRataMatching::Allocate(volumes, shares, 2, 3);
+  CHECK(shares[0] == 1);
+  CHECK(shares[1] == 1);
+  CHECK(shares[2] == 0);
+
+  // never more than an order has, whatever the padding
+  volumes = {7, 1, 9, 3, 5, 2, 8, 4, 6};
+  ProRataMatching::Allocate(volumes, shares, 44, 45);
+  int total = 0;
+  for (std::size_t i = 0; i < volumes.size(); ++i) {
+    CHECK(shares[i] <= volumes[i]);
+    total += shares[i];
+  }
+  CHECK(total == 44);
+}
+
+TEST_CASE("pro-rata books split a fill across the level and take a whole level in order") {
+  Fixture<ProRataBook> f;
+  f.book.Add(Resting(1, 100, 10, Order::Operation::SELL));
+  f.book.Add(Resting(2, 100, 30, Order::Operation::SELL));
+  f.book.Add(Resting(3, 100, 60, Order::Operation::SELL));
+
+  CHECK(Add(f.book, Resting(4, 100, 50, Order::Operation::BUY)) ==
+        std::vector<Trade>{{1, 100, 5}, {2, 100, 15}, {3, 100, 30}});
+  CHECK(f.book.TopAsk()->volume == 50);
+  CHECK(f.book.TopAsk()->orders == 3);
+
+  // enough for the whole level: everything goes, oldest first
+  CHECK(Add(f.book, Resting(5, 100, 60, Order::Operation::BUY)) ==
+        std::vector<Trade>{{1, 100, 5}, {2, 100, 15}, {3, 100, 30}});
+  CHECK(!f.book.BestAsk());
+  CHECK(f.book.TopBid()->volume == 10);
+}
+
+TEST_CASE("the id index keeps every key through churn and regrowth") {
+  FlatHashMap<OrderId, std::uint32_t, kNoOrderId> index;
+  std::map<OrderId, std::uint32_t> expected;
+  std::mt19937 random(11);
+  for (std::uint32_t step = 0; step < 20000; ++step) {
+    // few distinct keys, so erases hit and probe runs get shifted
+    OrderId id = 1 + random() % 3000;
+    if (random() % 3 == 0) {
+      CHECK(index.Erase(id) == (expected.erase(id) == 1));
+    } else {
+      CHECK(index.Insert(id, step) == expected.emplace(id, step).second);
+    }
+  }
+  CHECK(index.Size() == expected.size());
+  for (OrderId id = 1; id <= 3000; ++id) {
+    std::uint32_t* value = index.Find(id);
+    auto it = expected.find(id);
+    REQUIRE((value != nullptr) == (it != expected.end()));
+    if (value) CHECK(*value == it->second);
+  }
+}
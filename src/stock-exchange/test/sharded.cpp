@@ -0,0 +1,320 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "ExecutionReport.h"
+#include "Helpers.h"
+#include "IStockExchange.h"
+
+namespace {
+
+// operator new calls made by this thread while counting is on
+thread_local bool counting = false;
+thread_local std::size_t allocations = 0;
+
+} // namespace
+
+void* operator new(std::size_t p_Size) {
+  if (counting) ++allocations;
+  if (void* memory = std::malloc(p_Size == 0 ? 1 : p_Size)) return memory;
+  throw std::bad_alloc();
+}
+
+// out of line, or GCC takes the free() for a mismatch with a library new
+[[gnu::noinline]] void operator delete(void* p_Memory) noexcept { std::free(p_Memory); }
+[[gnu::noinline]] void operator delete(void* p_Memory, std::size_t) noexcept { std::free(p_Memory); }
+
+namespace {
+
+using Type = ExecutionReport::Type;
+
+constexpr const char* kSymbols[] = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "NVDA"};
+
+// Small sizes and no pinning: these run anywhere, on one core if need be.
+EngineConfig Sharded(IngestMode p_Ingest, std::size_t p_Shards = 3) {
+  EngineConfig config;
+  config.shards = p_Shards;
+  config.ingest = p_Ingest;
+  config.queueCapacity = 1024;
+  config.expectedOrders = 4096;
+  config.pinThreads = false;
+  config.quoteSymbols = 16;
+  return config;
+}
+
+struct Report {
+  OrderId id;
+  std::int64_t ticks;
+  int quantity;
+  int leaves;
+  Type type;
+
+  bool operator==(const Report&) const = default;
+};
+
+// Sequence numbers are per shard, and shards interleave: compare per symbol.
+std::map<SymbolId, std::vector<Report>> BySymbol(const std::vector<ExecutionReport>& p_Reports) {
+  std::map<SymbolId, std::vector<Report>> reports;
+  for (const ExecutionReport& report : p_Reports) {
+    reports[report.symbol].push_back(
+      Report{report.orderId, report.price.ticks, report.quantity, report.leaves, report.type});
+  }
+  return reports;
+}
+
+// A random flow of orders, cancels and modifies over kSymbols.
+void Flow(IStockExchange& p_Exchange, unsigned p_Seed) {
+  std::mt19937 random(p_Seed);
+  OrderId next = 1;
+  for (int step = 0; step < 3000; ++step) {
+    auto sym = static_cast<SymbolId>(random() % std::size(kSymbols));
+    unsigned action = random() % 10;
+    if (action < 7 || next == 1) {
+      auto ticks = static_cast<std::int64_t>(100 + random() % 10);
+      int volume = static_cast<int>(1 + random() % 20);
+      p_Exchange.Process(random() % 2 ? Buy(sym, ticks, volume, next) : Sell(sym, ticks, volume, next));
+      ++next;
+    } else if (action < 9) {
+      p_Exchange.Cancel(sym, random() % next + 1);
+    } else {
+      p_Exchange.Modify(sym, random() % next + 1, static_cast<int>(1 + random() % 20),
+                        Price{static_cast<std::int64_t>(100 + random() % 10)});
+    }
+  }
+}
+
+void Register(IStockExchange& p_Exchange) {
+  for (const char* name : kSymbols) p_Exchange.RegisterSymbol(name);
+}
+
+} // namespace
+
+TEST_CASE("shards report every symbol exactly as one engine does") {
+  auto single = IStockExchange::Create();
+  Register(*single);
+  Flow(*single, 1);
+  std::vector<ExecutionReport> expected = Reports(*single);
+
+  for (IngestMode ingest : {IngestMode::SPSC, IngestMode::MPSC, IngestMode::LOCKED}) {
+    CAPTURE(static_cast<int>(ingest));
+    auto sharded = IStockExchange::Create(Sharded(ingest));
+    Register(*sharded);
+    Flow(*sharded, 1);
+    std::vector<ExecutionReport> reports = Reports(*sharded, expected.size());
+    CHECK(reports.size() == expected.size());
+    CHECK(BySymbol(reports) == BySymbol(expected));
+  }
+}
+
+TEST_CASE("no shards at all means one") {
+  for (IngestMode ingest : {IngestMode::SYNC, IngestMode::SPSC, IngestMode::MPSC, IngestMode::LOCKED}) {
+    auto exchange = IStockExchange::Create(Sharded(ingest, 0));
+    Register(*exchange);
+    exchange->Process(Buy(0, 100, 5, 1));
+    exchange->Process(Sell(5, 100, 5, 2));
+    CHECK(Reports(*exchange, 2).size() == 2);
+  }
+}
+
+TEST_CASE("a sharded batch reports as one engine's batch does") {
+  std::mt19937 random(2);
+  std::vector<Order> orders;
+  for (OrderId id = 1; id <= 1000; ++id) {
+    auto sym = static_cast<SymbolId>(random() % std::size(kSymbols));
+    auto ticks = static_cast<std::int64_t>(100 + random() % 10);
+    orders.push_back(random() % 2 ? Buy(sym, ticks, 5, id) : Sell(sym, ticks, 5, id));
+  }
+  // each shard gets its part as one command, whatever the handoff
+  std::vector<Order> copy = orders;
+
+  auto single = IStockExchange::Create();
+  Register(*single);
+  single->ProcessBatch(copy);
+  std::vector<ExecutionReport> expected = Reports(*single);
+
+  for (IngestMode ingest : {IngestMode::LOCKED, IngestMode::SPSC, IngestMode::MPSC}) {
+    CAPTURE(ingest);
+    copy = orders;
+    auto sharded = IStockExchange::Create(Sharded(ingest));
+    Register(*sharded);
+    sharded->ProcessBatch(copy);
+    CHECK(BySymbol(Reports(*sharded, expected.size())) == BySymbol(expected));
+  }
+}
+
+TEST_CASE("shards hand batch buffers back, so the caller stops allocating for batches") {
+  for (IngestMode ingest : {IngestMode::LOCKED, IngestMode::SPSC, IngestMode::MPSC}) {
+    CAPTURE(ingest);
+    auto exchange = IStockExchange::Create(Sharded(ingest));
+    Register(*exchange);
+    // bids only, so each order gets just its NEW; the same mix every time
+    std::vector<std::vector<Order>> batches(40);
+    OrderId id = 1;
+    for (std::vector<Order>& batch : batches) {
+      for (int i = 0; i < 60; ++i, ++id) {
+        batch.push_back(Buy(static_cast<SymbolId>(i % std::size(kSymbols)), 100 - i / 6, 1, id));
+      }
+    }
+    std::size_t allocated = 0;
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+      // the first few fill the shards' spares and the caller's tables
+      counting = i >= 4;
+      allocations = 0;
+      exchange->ProcessBatch(batches[i]);
+      counting = false;
+      allocated += allocations;
+      // once its reports are out, a shard has given the buffer back
+      REQUIRE(Reports(*exchange, 60).size() == 60);
+    }
+    CHECK(allocated == 0);
+  }
+}
+
+TEST_CASE("cancel and modify go to the shard that owns the symbol") {
+  auto exchange = IStockExchange::Create(Sharded(IngestMode::SPSC, 4));
+  Register(*exchange);
+  SymbolId aapl = 0;
+  SymbolId msft = 1;
+  exchange->Process(Sell(aapl, 100, 5, 1));
+  exchange->Process(Sell(msft, 100, 5, 2));
+  CHECK(Reports(*exchange, 2).size() == 2);
+
+  // a wrong symbol, possibly another shard's, or an id nobody has
+  exchange->Cancel(msft, 1);
+  exchange->Cancel(aapl, 42);
+  exchange->Modify(aapl, 2, 1, Price{100});
+  std::vector<ExecutionReport> reports = Reports(*exchange, 3);
+  REQUIRE(reports.size() == 3);
+  std::multiset<OrderId> rejected;
+  for (const ExecutionReport& report : reports) {
+    CHECK(report.type == Type::REJECTED);
+    rejected.insert(report.orderId);
+  }
+  CHECK(rejected == std::multiset<OrderId>{1, 2, 42});
+
+  // the orders are where they were
+  exchange->Modify(aapl, 1, 3, Price{100});
+  exchange->Cancel(msft, 2);
+  reports = Reports(*exchange, 2);
+  REQUIRE(reports.size() == 2);
+  auto bySymbol = BySymbol(reports);
+  CHECK(bySymbol[aapl] == std::vector<Report>{{1, 100, 0, 3, Type::REPLACED}});
+  CHECK(bySymbol[msft] == std::vector<Report>{{2, 100, 0, 0, Type::CANCELED}});
+}
+
+TEST_CASE("orders without a symbol are REJECTED by the front") {
+  auto exchange = IStockExchange::Create(Sharded(IngestMode::MPSC));
+  CHECK(exchange->RegisterSymbol("") == kInvalidSymbol);
+  exchange->Process(Order{"", Price{100}, 5, Order::Operation::BUY, kInvalidSymbol, 7});
+  exchange->Process(Order{"AAPL", Price{100}, 5, Order::Operation::BUY, kInvalidSymbol, 8});
+  std::vector<ExecutionReport> reports = Reports(*exchange, 2);
+  REQUIRE(reports.size() == 2);
+  std::map<OrderId, Type> types;
+  for (const ExecutionReport& report : reports) types[report.orderId] = report.type;
+  CHECK(types[7] == Type::REJECTED);
+  CHECK(types[8] == Type::NEW);
+}
+
+TEST_CASE("the front's price scale changes only with its shard's book") {
+  auto exchange = IStockExchange::Create(Sharded(IngestMode::SPSC));
+  BookConfig config;
+  config.priceScale = 1000;
+  exchange->ConfigureBook("AAPL", config);
+  SymbolId sym = exchange->RegisterSymbol("AAPL");
+  CHECK(exchange->ToPrice(sym, 1.5) == Price{1500});
+
+  exchange->Process(Buy(sym, 1500, 5, 1));
+  CHECK(Reports(*exchange, 1).size() == 1);
+  config.priceScale = 100;
+  exchange->ConfigureBook("AAPL", config);
+  CHECK(exchange->ToPrice(sym, 1.5) == Price{1500});
+
+  // empty again, so the shard takes it now
+  exchange->Cancel(sym, 1);
+  CHECK(Reports(*exchange, 1).size() == 1);
+  exchange->ConfigureBook("AAPL", config);
+  CHECK(exchange->ToPrice(sym, 1.5) == Price{150});
+
+  // a scale that isn't positive never reaches the shard
+  config.priceScale = 0;
+  exchange->ConfigureBook("AAPL", config);
+  CHECK(exchange->ToPrice(sym, 1.5) == Price{150});
+}
+
+TEST_CASE("sharded display shows the shards' snapshots") {
+  EngineConfig config = Sharded(IngestMode::SPSC);
+  config.snapshotLevels = 10;
+  auto sharded = IStockExchange::Create(config);
+  config = EngineConfig{};
+  config.snapshotLevels = 10;
+  auto single = IStockExchange::Create(config);
+  for (IStockExchange* exchange : {sharded.get(), single.get()}) {
+    Register(*exchange);
+    OrderId id = 1;
+    for (SymbolId sym = 0; sym < std::size(kSymbols); ++sym) {
+      for (std::int64_t ticks = 95; ticks < 100; ++ticks) exchange->Process(Buy(sym, ticks, 2, id++));
+      for (std::int64_t ticks = 101; ticks < 104; ++ticks) exchange->Process(Sell(sym, ticks, 3, id++));
+    }
+  }
+  auto text = [](IStockExchange& p_Exchange) {
+    std::string lines;
+    p_Exchange.DisplayOrders(DisplayQuery{}, [&](std::string_view p_Chunk) { lines += p_Chunk; });
+    return lines;
+  };
+  std::string expected = text(*single);
+  CHECK(!expected.empty());
+  // snapshots come out after the reports, some time after Process returns
+  CHECK(Eventually([&] { return text(*sharded) == expected; }));
+
+  std::string paged;
+  DisplayQuery query;
+  char buffer[64];
+  do {
+    DisplayPage page = sharded->DisplayOrders(query, buffer);
+    paged.append(buffer, page.size);
+    query.cursor = page.next;
+  } while (!query.cursor.done);
+  CHECK(paged == expected);
+}
+
+TEST_CASE("many gateway threads can feed an MPSC engine") {
+  auto exchange = IStockExchange::Create(Sharded(IngestMode::MPSC));
+  Register(*exchange);
+  std::atomic<int> completed{0};
+  exchange->SetCompletionCallback([&](const Order&, int) { completed.fetch_add(1); });
+
+  constexpr int kThreads = 3;
+  constexpr int kOrders = 500;
+  std::vector<std::thread> gateways;
+  for (int t = 0; t < kThreads; ++t) {
+    gateways.emplace_back([&, t] {
+      for (int i = 0; i < kOrders; ++i) {
+        auto id = static_cast<OrderId>(t * kOrders + i + 1);
+        // each thread on a price band of its own, so nothing trades
+        auto sym = static_cast<SymbolId>(i % std::size(kSymbols));
+        std::int64_t ticks = t == 0 ? 100 : 200 + t;
+        exchange->Process(t == 0 ? Buy(sym, ticks, 1, id) : Sell(sym, ticks, 1, id));
+      }
+    });
+  }
+  for (std::thread& gateway : gateways) gateway.join();
+
+  std::vector<ExecutionReport> reports = Reports(*exchange, kThreads * kOrders);
+  REQUIRE(reports.size() == kThreads * kOrders);
+  std::set<OrderId> ids;
+  for (const ExecutionReport& report : reports) {
+    CHECK(report.type == Type::NEW);
+    ids.insert(report.orderId);
+  }
+  CHECK(ids.size() == kThreads * kOrders);
+  CHECK(Eventually([&] { return completed.load() == kThreads * kOrders; }));
+}